@@ -0,0 +1,380 @@
+// renderdoclab_bench: runs every example headless and collects their --stats-json output.
+//
+//   renderdoclab_bench [--frames N] [--out results.json] [--device cpu|discrete|integrated|any]
+//                      [--baseline baseline.json] [--threshold 0.10] [example ...]
+//
+// The examples are started as child processes from the directory holding this
+// executable, with RENDERDOCLAB_DEVICE_TYPE set so they all pick the same
+// device (a software rasterizer such as lavapipe by default). With --baseline
+// every time metric is compared against a previous results file and the exit
+// code is 2 when one got slower by more than the threshold, or when an example
+// in the baseline produced no results. The exit code is 1 when an example fails.
+
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static const std::vector<std::string> DEFAULT_EXAMPLES = {
+    "0_HelloTriangle",
+    "1_VertexBuffer",
+    "2_TextureMapping",
+    "3_Compute",
+    "4_ComputeSkinning",
+    "5_ParallelRecording",
+};
+
+// Metrics compared against the baseline; all of them are times where lower is better
+static const std::vector<std::string> COMPARED_METRICS = {
+    "frameMs.p50",
+    "frameMs.p99",
+    "cpuSubmitMs.p50",
+    "cpuSubmitMs.p99",
+    "gpuMs.p50",
+    "gpuMs.p99",
+};
+
+// Differences below this are timer noise, whatever the relative change
+static const double MIN_REGRESSION_MS = 0.01;
+
+// Flattens every number in a JSON document into "a.b.c" -> value. Strings, booleans and
+// nulls are skipped; that is all the comparison needs from the stats files.
+class JsonFlattener
+{
+public:
+    explicit JsonFlattener(const std::string &text) : text(text) {}
+
+    std::map<std::string, double> flatten()
+    {
+        std::map<std::string, double> values;
+        parseValue("", values);
+        return values;
+    }
+
+private:
+    void skipWhitespace()
+    {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+            pos++;
+    }
+
+    void expect(char c)
+    {
+        skipWhitespace();
+        if (pos >= text.size() || text[pos] != c)
+        {
+            throw std::runtime_error(std::string("Malformed JSON: expected '") + c + "' at offset " +
+                                     std::to_string(pos));
+        }
+        pos++;
+    }
+
+    std::string parseString()
+    {
+        expect('"');
+        std::string result;
+        while (pos < text.size() && text[pos] != '"')
+        {
+            if (text[pos] == '\\' && pos + 1 < text.size())
+                pos++;
+            result += text[pos++];
+        }
+        expect('"');
+        return result;
+    }
+
+    void parseValue(const std::string &path, std::map<std::string, double> &values)
+    {
+        skipWhitespace();
+        if (pos >= text.size())
+            throw std::runtime_error("Malformed JSON: unexpected end");
+
+        char c = text[pos];
+        if (c == '{')
+        {
+            pos++;
+            skipWhitespace();
+            if (text[pos] == '}')
+            {
+                pos++;
+                return;
+            }
+            do
+            {
+                std::string key = parseString();
+                expect(':');
+                parseValue(path.empty() ? key : path + "." + key, values);
+                skipWhitespace();
+            } while (text[pos++] == ',');
+            if (text[pos - 1] != '}')
+                throw std::runtime_error("Malformed JSON: unterminated object");
+        }
+        else if (c == '[')
+        {
+            pos++;
+            skipWhitespace();
+            if (text[pos] == ']')
+            {
+                pos++;
+                return;
+            }
+            size_t index = 0;
+            do
+            {
+                parseValue(path + "." + std::to_string(index++), values);
+                skipWhitespace();
+            } while (text[pos++] == ',');
+            if (text[pos - 1] != ']')
+                throw std::runtime_error("Malformed JSON: unterminated array");
+        }
+        else if (c == '"')
+        {
+            parseString();
+        }
+        else if (c == '-' || std::isdigit(static_cast<unsigned char>(c)))
+        {
+            size_t length = 0;
+            values[path] = std::stod(text.substr(pos), &length);
+            pos += length;
+        }
+        else
+        {
+            // true, false or null
+            while (pos < text.size() && std::isalpha(static_cast<unsigned char>(text[pos])))
+                pos++;
+        }
+    }
+
+    const std::string &text;
+    size_t pos = 0;
+};
+
+static std::string readText(const std::filesystem::path &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + path.string());
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+static void setEnvironment(const char *name, const std::string &value)
+{
+#ifdef _WIN32
+    _putenv_s(name, value.c_str());
+#else
+    setenv(name, value.c_str(), 1);
+#endif
+}
+
+static std::filesystem::path executablePath(const std::filesystem::path &directory, const std::string &name)
+{
+#ifdef _WIN32
+    return directory / (name + ".exe");
+#else
+    return directory / name;
+#endif
+}
+
+// Runs one example and returns its stats JSON, or an empty string on failure
+static std::string runExample(const std::filesystem::path &binDir, const std::string &name, uint32_t frames)
+{
+    std::filesystem::path executable = executablePath(binDir, name);
+    if (!std::filesystem::exists(executable))
+    {
+        std::cerr << name << ": not built, skipping" << std::endl;
+        return "";
+    }
+
+    std::filesystem::path statsPath = std::filesystem::temp_directory_path() / ("renderdoclab_bench_" + name + ".json");
+    std::filesystem::remove(statsPath);
+
+    std::string command = "\"" + executable.string() + "\" --headless " + std::to_string(frames) +
+                          " --benchmark " + std::to_string(frames) + " --stats-json \"" + statsPath.string() + "\"";
+#ifdef _WIN32
+    // cmd.exe strips the outer quotes of the whole line
+    command = "\"" + command + "\"";
+#endif
+
+    std::cout << "Running " << name << " for " << frames << " frames..." << std::endl;
+    int result = std::system(command.c_str());
+    if (result != 0 || !std::filesystem::exists(statsPath))
+    {
+        std::cerr << name << ": failed with exit code " << result << std::endl;
+        return "";
+    }
+
+    std::string stats = readText(statsPath);
+    std::filesystem::remove(statsPath);
+    while (!stats.empty() && std::isspace(static_cast<unsigned char>(stats.back())))
+        stats.pop_back();
+    return stats;
+}
+
+static void printResults(const std::map<std::string, double> &values, const std::vector<std::string> &examples)
+{
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::left << std::setw(20) << "example" << std::right << std::setw(10) << "fps" << std::setw(12)
+              << "frame p50" << std::setw(12) << "frame p99" << std::setw(12) << "submit p50" << std::setw(12)
+              << "gpu p50" << std::endl;
+    for (const std::string &example : examples)
+    {
+        auto get = [&](const std::string &metric)
+        {
+            auto it = values.find("examples." + example + "." + metric);
+            return it == values.end() ? 0.0 : it->second;
+        };
+        if (values.find("examples." + example + ".frames") == values.end())
+            continue;
+        std::cout << std::left << std::setw(20) << example << std::right << std::setw(10) << get("fps") << std::setw(12)
+                  << get("frameMs.p50") << std::setw(12) << get("frameMs.p99") << std::setw(12)
+                  << get("cpuSubmitMs.p50") << std::setw(12) << get("gpuMs.p50") << std::endl;
+    }
+}
+
+// Returns the number of regressed metrics
+static int compareWithBaseline(const std::map<std::string, double> &current, const std::map<std::string, double> &baseline,
+                               const std::vector<std::string> &examples, double threshold)
+{
+    int regressions = 0;
+    std::cout << "Comparing against baseline (threshold " << threshold * 100.0 << "%)" << std::endl;
+    for (const std::string &example : examples)
+    {
+        // An example that crashed must not pass just because it has nothing to compare
+        std::string framesKey = "examples." + example + ".frames";
+        if (baseline.count(framesKey) && !current.count(framesKey))
+        {
+            std::cout << "  REGRESSION " << example << ": in the baseline but produced no results" << std::endl;
+            regressions++;
+            continue;
+        }
+
+        for (const std::string &metric : COMPARED_METRICS)
+        {
+            std::string key = "examples." + example + "." + metric;
+            auto cur = current.find(key);
+            auto base = baseline.find(key);
+            if (cur == current.end() || base == baseline.end() || base->second <= 0.0)
+                continue;
+
+            double change = (cur->second - base->second) / base->second;
+            bool regressed = change > threshold && cur->second - base->second > MIN_REGRESSION_MS;
+            if (regressed || change < -threshold)
+            {
+                std::cout << "  " << (regressed ? "REGRESSION " : "improved   ") << example << " " << metric << ": "
+                          << base->second << " -> " << cur->second << " ms (" << std::showpos << change * 100.0
+                          << std::noshowpos << "%)" << std::endl;
+            }
+            if (regressed)
+                regressions++;
+        }
+    }
+    if (regressions == 0)
+        std::cout << "  no regressions" << std::endl;
+    return regressions;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = 500;
+    std::filesystem::path outPath = "renderdoclab_bench.json";
+    std::filesystem::path baselinePath;
+    std::string deviceType = "cpu";
+    double threshold = 0.10;
+    std::vector<std::string> examples;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc)
+            frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--out" && i + 1 < argc)
+            outPath = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (arg == "--device" && i + 1 < argc)
+            deviceType = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc)
+            threshold = std::stod(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-')
+            examples.push_back(arg);
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (examples.empty())
+        examples = DEFAULT_EXAMPLES;
+
+    try
+    {
+        // Examples find their shaders relative to the working directory as a fallback
+        std::filesystem::path binDir = std::filesystem::absolute(argv[0]).parent_path();
+        outPath = std::filesystem::absolute(outPath);
+        if (!baselinePath.empty())
+            baselinePath = std::filesystem::absolute(baselinePath);
+        std::filesystem::current_path(binDir);
+
+        if (deviceType != "any")
+            setEnvironment("RENDERDOCLAB_DEVICE_TYPE", deviceType);
+
+        std::ostringstream results;
+        results << "{\n\"frames\": " << frames << ",\n\"deviceType\": \"" << deviceType << "\",\n\"examples\": {";
+        bool first = true;
+        int failedExamples = 0;
+        for (const std::string &example : examples)
+        {
+            std::string stats = runExample(binDir, example, frames);
+            if (stats.empty())
+            {
+                failedExamples++;
+                continue;
+            }
+            results << (first ? "\n" : ",\n") << "\"" << example << "\": " << stats;
+            first = false;
+        }
+        results << "}\n}\n";
+
+        std::ofstream out(outPath);
+        out << results.str();
+        out.close();
+        std::cout << "Results written to " << outPath.string() << std::endl;
+
+        std::map<std::string, double> current = JsonFlattener(results.str()).flatten();
+        printResults(current, examples);
+
+        int regressions = 0;
+        if (!baselinePath.empty())
+        {
+            std::string baselineText = readText(baselinePath);
+            std::map<std::string, double> baseline = JsonFlattener(baselineText).flatten();
+            regressions = compareWithBaseline(current, baseline, examples, threshold);
+        }
+
+        if (failedExamples > 0)
+        {
+            std::cerr << failedExamples << " of " << examples.size() << " examples failed" << std::endl;
+            return 1;
+        }
+        if (regressions > 0)
+            return 2;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include "barrier_builder.h"
+
+#include <stdexcept>
+
+PFN_vkCmdPipelineBarrier2 BarrierBuilder::loadPipelineBarrier2(VkDevice device, Synchronization2Support support)
+{
+    if (support == Synchronization2Support::Core)
+    {
+        return (PFN_vkCmdPipelineBarrier2)vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2");
+    }
+    if (support == Synchronization2Support::Extension)
+    {
+        return (PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2KHR");
+    }
+    return nullptr;
+}
+
+LayoutAccess BarrierBuilder::getLayoutAccess(VkImageLayout layout)
+{
+    LayoutAccess result;
+    switch (layout)
+    {
+    case VK_IMAGE_LAYOUT_UNDEFINED:
+        result.stages = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_PREINITIALIZED:
+        result.stages = VK_PIPELINE_STAGE_2_HOST_BIT;
+        result.access = VK_ACCESS_2_HOST_WRITE_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_GENERAL:
+        result.stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        result.access = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        result.stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        result.access = VK_ACCESS_2_TRANSFER_READ_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+        result.stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        result.access = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        // Sampled by graphics or compute shaders
+        result.stages = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+                        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        result.access = VK_ACCESS_2_SHADER_READ_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        result.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        result.access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        result.stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+        result.access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+        result.stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT |
+                        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+        result.access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+        // Presentation is ordered by semaphores; this stage is the one swapchain acquires wait at
+        result.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        break;
+    default:
+        throw std::runtime_error("Unsupported layout transition!");
+    }
+    return result;
+}
+
+VkImageSubresourceRange BarrierBuilder::subresourceRange(VkImageAspectFlags aspectMask, uint32_t baseMipLevel,
+                                                         uint32_t levelCount, uint32_t baseArrayLayer,
+                                                         uint32_t layerCount)
+{
+    VkImageSubresourceRange range{};
+    range.aspectMask = aspectMask;
+    range.baseMipLevel = baseMipLevel;
+    range.levelCount = levelCount;
+    range.baseArrayLayer = baseArrayLayer;
+    range.layerCount = layerCount;
+    return range;
+}
+
+VkImageMemoryBarrier2 BarrierBuilder::transitionBarrier(VkImage image, VkImageLayout oldLayout,
+                                                        VkImageLayout newLayout, const VkImageSubresourceRange &range)
+{
+    // Nothing can be read back out of UNDEFINED
+    if (newLayout == VK_IMAGE_LAYOUT_UNDEFINED || newLayout == VK_IMAGE_LAYOUT_PREINITIALIZED)
+    {
+        throw std::runtime_error("Unsupported layout transition!");
+    }
+    LayoutAccess src = getLayoutAccess(oldLayout);
+    LayoutAccess dst = getLayoutAccess(newLayout);
+
+    VkImageMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = src.stages;
+    // Only writes need to be made available
+    barrier.srcAccessMask = src.access & (VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_SHADER_WRITE_BIT |
+                                          VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+                                          VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+    barrier.dstStageMask = dst.stages;
+    barrier.dstAccessMask = dst.access;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = range;
+    return barrier;
+}
+
+void BarrierBuilder::transition(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                const VkImageSubresourceRange &range)
+{
+    this->image(transitionBarrier(image, oldLayout, newLayout, range));
+}
+
+void BarrierBuilder::memory(VkPipelineStageFlags2 srcStages, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStages,
+                            VkAccessFlags2 dstAccess)
+{
+    VkMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = srcStages;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = dstStages;
+    barrier.dstAccessMask = dstAccess;
+    memoryBarriers.push_back(barrier);
+}
+
+void BarrierBuilder::buffer(VkBuffer buffer, VkPipelineStageFlags2 srcStages, VkAccessFlags2 srcAccess,
+                            VkPipelineStageFlags2 dstStages, VkAccessFlags2 dstAccess, VkDeviceSize offset,
+                            VkDeviceSize size)
+{
+    VkBufferMemoryBarrier2 barrier{};
+    barrier.srcStageMask = srcStages;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = dstStages;
+    barrier.dstAccessMask = dstAccess;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+    this->buffer(barrier);
+}
+
+void BarrierBuilder::buffer(const VkBufferMemoryBarrier2 &barrier)
+{
+    bufferBarriers.push_back(barrier);
+    bufferBarriers.back().sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+}
+
+void BarrierBuilder::image(const VkImageMemoryBarrier2 &barrier)
+{
+    imageBarriers.push_back(barrier);
+    imageBarriers.back().sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+}
+
+void BarrierBuilder::flush(VkCommandBuffer commandBuffer)
+{
+    if (empty())
+        return;
+
+    if (pipelineBarrier2)
+    {
+        VkDependencyInfo dependencyInfo{};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.memoryBarrierCount = static_cast<uint32_t>(memoryBarriers.size());
+        dependencyInfo.pMemoryBarriers = memoryBarriers.data();
+        dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+        dependencyInfo.pBufferMemoryBarriers = bufferBarriers.data();
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+        dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+        pipelineBarrier2(commandBuffer, &dependencyInfo);
+        clear();
+        return;
+    }
+
+    // The 1.0 stage and access bits have the same values in the synchronization2 masks
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+
+    std::vector<VkMemoryBarrier> legacyMemory;
+    for (const VkMemoryBarrier2 &barrier : memoryBarriers)
+    {
+        VkMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        legacy.srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+        legacy.dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+        legacyMemory.push_back(legacy);
+        srcStages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+        dstStages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+    }
+
+    std::vector<VkBufferMemoryBarrier> legacyBuffers;
+    for (const VkBufferMemoryBarrier2 &barrier : bufferBarriers)
+    {
+        VkBufferMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        legacy.srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+        legacy.dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.buffer = barrier.buffer;
+        legacy.offset = barrier.offset;
+        legacy.size = barrier.size;
+        legacyBuffers.push_back(legacy);
+        srcStages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+        dstStages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+    }
+
+    std::vector<VkImageMemoryBarrier> legacyImages;
+    for (const VkImageMemoryBarrier2 &barrier : imageBarriers)
+    {
+        VkImageMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        legacy.srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+        legacy.dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+        legacy.oldLayout = barrier.oldLayout;
+        legacy.newLayout = barrier.newLayout;
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.image = barrier.image;
+        legacy.subresourceRange = barrier.subresourceRange;
+        legacyImages.push_back(legacy);
+        srcStages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+        dstStages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+    }
+
+    // Stage masks may not be empty before synchronization2
+    if (srcStages == 0)
+        srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    if (dstStages == 0)
+        dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0,
+                         static_cast<uint32_t>(legacyMemory.size()), legacyMemory.data(),
+                         static_cast<uint32_t>(legacyBuffers.size()), legacyBuffers.data(),
+                         static_cast<uint32_t>(legacyImages.size()), legacyImages.data());
+    clear();
+}
+
+void BarrierBuilder::clear()
+{
+    memoryBarriers.clear();
+    bufferBarriers.clear();
+    imageBarriers.clear();
+}
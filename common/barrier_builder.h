@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+// The pipeline stages and accesses that use an image while it is in a given layout
+struct LayoutAccess
+{
+  VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+  VkAccessFlags2 access = VK_ACCESS_2_NONE;
+};
+
+// How a device provides vkCmdPipelineBarrier2
+enum class Synchronization2Support
+{
+  None,
+  // Core in Vulkan 1.3
+  Core,
+  // VK_KHR_synchronization2 on an older device
+  Extension
+};
+
+// Accumulates memory, buffer and image barriers and records them as one dependency.
+//
+// Barriers are described with synchronization2 stage and access masks, so each one
+// carries its own stages. flush() records them with a single vkCmdPipelineBarrier2
+// when the builder was given that device's entry point (see loadPipelineBarrier2,
+// which also works with loaders older than 1.3). Otherwise it records a single
+// vkCmdPipelineBarrier whose stage masks are the union of all the barriers' masks.
+// That fallback is only exact for stages and accesses that exist in Vulkan 1.0,
+// which are the only ones getLayoutAccess() uses.
+class BarrierBuilder
+{
+public:
+  // vkCmdPipelineBarrier2 or vkCmdPipelineBarrier2KHR of a device created with support enabled;
+  // null when support is None or the lookup fails
+  static PFN_vkCmdPipelineBarrier2 loadPipelineBarrier2(VkDevice device, Synchronization2Support support);
+
+  // pipelineBarrier2 comes from loadPipelineBarrier2 for the device the command buffers belong
+  // to; without it barriers are recorded with vkCmdPipelineBarrier
+  explicit BarrierBuilder(PFN_vkCmdPipelineBarrier2 pipelineBarrier2 = nullptr) : pipelineBarrier2(pipelineBarrier2) {}
+  bool usesSynchronization2() const { return pipelineBarrier2 != nullptr; }
+
+  // Throws for layouts no stage is known to use
+  static LayoutAccess getLayoutAccess(VkImageLayout layout);
+  static VkImageSubresourceRange subresourceRange(VkImageAspectFlags aspectMask, uint32_t baseMipLevel = 0,
+                                                  uint32_t levelCount = VK_REMAINING_MIP_LEVELS,
+                                                  uint32_t baseArrayLayer = 0,
+                                                  uint32_t layerCount = VK_REMAINING_ARRAY_LAYERS);
+
+  // Layout transition of range, waiting for the work that uses oldLayout and blocking
+  // the work that uses newLayout
+  static VkImageMemoryBarrier2 transitionBarrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                                 const VkImageSubresourceRange &range);
+  void transition(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                  const VkImageSubresourceRange &range);
+  void memory(VkPipelineStageFlags2 srcStages, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStages,
+              VkAccessFlags2 dstAccess);
+  void buffer(VkBuffer buffer, VkPipelineStageFlags2 srcStages, VkAccessFlags2 srcAccess,
+              VkPipelineStageFlags2 dstStages, VkAccessFlags2 dstAccess, VkDeviceSize offset = 0,
+              VkDeviceSize size = VK_WHOLE_SIZE);
+  // Fully specified barriers, e.g. for queue family ownership transfers. sType is filled in.
+  void buffer(const VkBufferMemoryBarrier2 &barrier);
+  void image(const VkImageMemoryBarrier2 &barrier);
+
+  bool empty() const { return memoryBarriers.empty() && bufferBarriers.empty() && imageBarriers.empty(); }
+  // Records every accumulated barrier, then clears them
+  void flush(VkCommandBuffer commandBuffer);
+  void clear();
+
+private:
+  PFN_vkCmdPipelineBarrier2 pipelineBarrier2 = nullptr;
+  std::vector<VkMemoryBarrier2> memoryBarriers;
+  std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+  std::vector<VkImageMemoryBarrier2> imageBarriers;
+};
@@ -0,0 +1,205 @@
+#include "cpu_profiler.h"
+#include "gpu_profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+// Written only by its owning thread; count is published with release so the exporter
+// sees complete events
+struct CpuThreadBuffer
+{
+    uint32_t threadId = 0;
+    std::string name;
+    std::unique_ptr<CpuZoneEvent[]> events{new CpuZoneEvent[CpuProfiler::EVENTS_PER_THREAD]};
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> dropped{0};
+};
+
+struct CpuProfilerRegistry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<CpuThreadBuffer>> buffers;
+};
+
+static CpuProfilerRegistry &registry()
+{
+    static CpuProfilerRegistry instance;
+    return instance;
+}
+
+static CpuThreadBuffer &threadBuffer()
+{
+    thread_local CpuThreadBuffer *buffer = nullptr;
+    if (!buffer)
+    {
+        CpuProfilerRegistry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.buffers.push_back(std::make_unique<CpuThreadBuffer>());
+        buffer = reg.buffers.back().get();
+        buffer->threadId = static_cast<uint32_t>(reg.buffers.size() - 1);
+        buffer->name = "thread " + std::to_string(buffer->threadId);
+    }
+    return *buffer;
+}
+
+static std::string escapeJson(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20)
+            escaped += c;
+    }
+    return escaped;
+}
+
+void writeTraceFile(const std::filesystem::path &path, const std::vector<std::string> &events)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open trace file: " + path.string());
+    }
+
+    file << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        file << events[i] << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+}
+
+std::atomic<bool> &CpuProfiler::enabledFlag()
+{
+    static std::atomic<bool> enabled{false};
+    return enabled;
+}
+
+void CpuProfiler::setThreadName(const std::string &name)
+{
+    CpuThreadBuffer &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.name = name;
+}
+
+void CpuProfiler::record(const char *name, double startUs, double endUs, uint32_t depth)
+{
+    CpuThreadBuffer &buffer = threadBuffer();
+    size_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index >= EVENTS_PER_THREAD)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events[index] = {name, startUs, endUs - startUs, depth};
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+std::vector<CpuZoneEvent> CpuProfiler::getThreadEvents()
+{
+    CpuThreadBuffer &buffer = threadBuffer();
+    size_t count = buffer.count.load(std::memory_order_relaxed);
+    return std::vector<CpuZoneEvent>(buffer.events.get(), buffer.events.get() + count);
+}
+
+std::vector<CpuZoneEvent> CpuProfiler::getOtherThreadEvents()
+{
+    CpuThreadBuffer *own = &threadBuffer();
+    CpuProfilerRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    std::vector<CpuZoneEvent> events;
+    for (const auto &buffer : reg.buffers)
+    {
+        if (buffer.get() == own)
+            continue;
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        events.insert(events.end(), buffer->events.get(), buffer->events.get() + count);
+    }
+    return events;
+}
+
+void CpuProfiler::appendTraceEvents(std::vector<std::string> &events)
+{
+    CpuProfilerRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    // pid 1 is the CPU; the GPU profiler uses pid 2
+    events.push_back("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}}");
+    for (const auto &buffer : reg.buffers)
+    {
+        std::ostringstream meta;
+        meta << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+             << ",\"args\":{\"name\":\"" << escapeJson(buffer->name) << "\"}}";
+        events.push_back(meta.str());
+
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++)
+        {
+            const CpuZoneEvent &event = buffer->events[i];
+            std::ostringstream out;
+            out.precision(3);
+            out << std::fixed << "{\"name\":\"" << escapeJson(event.name) << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << buffer->threadId << ",\"ts\":" << event.startUs << ",\"dur\":" << event.durationUs << "}";
+            events.push_back(out.str());
+        }
+    }
+}
+
+void CpuProfiler::writeChromeTrace(const std::filesystem::path &path, const GpuProfiler *gpuProfiler)
+{
+    std::vector<std::string> events;
+    appendTraceEvents(events);
+    if (gpuProfiler && gpuProfiler->isEnabled())
+    {
+        gpuProfiler->appendTraceEvents(events);
+    }
+    writeTraceFile(path, events);
+}
+
+void CpuProfiler::printSummary()
+{
+    struct Stats
+    {
+        size_t count = 0;
+        double total = 0.0;
+        double max = 0.0;
+    };
+    std::map<std::string, Stats> byName;
+    size_t dropped = 0;
+
+    CpuProfilerRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto &buffer : reg.buffers)
+    {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++)
+        {
+            const CpuZoneEvent &event = buffer->events[i];
+            Stats &stats = byName[event.name];
+            stats.count++;
+            stats.total += event.durationUs;
+            stats.max = std::max(stats.max, event.durationUs);
+        }
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+
+    std::cout << "CPU zones";
+    if (dropped > 0)
+        std::cout << " (" << dropped << " dropped)";
+    std::cout << ":" << std::endl;
+    for (const auto &[name, stats] : byName)
+    {
+        std::cout << "  " << name << ": mean " << stats.total / stats.count << " us, max " << stats.max << " us over "
+                  << stats.count << " samples" << std::endl;
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+class GpuProfiler;
+
+// Time base shared by the CPU and GPU profilers: steady_clock in microseconds
+inline double profilerClockMicros()
+{
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Writes Chrome trace events (already serialized JSON objects) as a trace file
+void writeTraceFile(const std::filesystem::path &path, const std::vector<std::string> &events);
+
+struct CpuZoneEvent
+{
+  const char *name;
+  double startUs;
+  double durationUs;
+  // Number of enclosing zones on the same thread
+  uint32_t depth;
+};
+
+// CPU instrumentation with scoped zones.
+//
+// Every thread records into its own fixed-size buffer, registered under a mutex
+// the first time the thread records. After that a zone costs two clock reads and
+// a store with no locking or allocation. Buffers live until exit, so events from
+// finished threads are still exported. Zone names must be string literals.
+// Export while no other thread is recording (e.g. after the main loop).
+class CpuProfiler
+{
+public:
+  static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+  static void setEnabled(bool enabled) { enabledFlag().store(enabled, std::memory_order_relaxed); }
+  static bool isEnabled() { return enabledFlag().load(std::memory_order_relaxed); }
+
+  // Names the calling thread's row in the trace
+  static void setThreadName(const std::string &name);
+
+  static void record(const char *name, double startUs, double endUs, uint32_t depth);
+
+  // Events recorded so far by the calling thread, in completion order
+  static std::vector<CpuZoneEvent> getThreadEvents();
+  // Events recorded so far by every other thread, e.g. job system workers. Depths are per thread.
+  static std::vector<CpuZoneEvent> getOtherThreadEvents();
+
+  // Appends serialized trace events for every thread
+  static void appendTraceEvents(std::vector<std::string> &events);
+  // Writes the CPU trace, merged with the GPU zones when gpuProfiler is given and enabled
+  static void writeChromeTrace(const std::filesystem::path &path, const GpuProfiler *gpuProfiler = nullptr);
+  // Prints mean and max duration per zone name across all threads
+  static void printSummary();
+
+private:
+  static std::atomic<bool> &enabledFlag();
+};
+
+// Scoped zone; prefer the CPU_ZONE macro
+class CpuZone
+{
+public:
+  explicit CpuZone(const char *name)
+  {
+    if (!CpuProfiler::isEnabled())
+      return;
+    this->name = name;
+    depth = threadDepth()++;
+    startUs = profilerClockMicros();
+  }
+  ~CpuZone()
+  {
+    if (!name)
+      return;
+    threadDepth()--;
+    CpuProfiler::record(name, startUs, profilerClockMicros(), depth);
+  }
+
+  CpuZone(const CpuZone &) = delete;
+  CpuZone &operator=(const CpuZone &) = delete;
+
+private:
+  static uint32_t &threadDepth()
+  {
+    thread_local uint32_t depth = 0;
+    return depth;
+  }
+
+  const char *name = nullptr;
+  double startUs = 0.0;
+  uint32_t depth = 0;
+};
+
+#define CPU_ZONE_CONCAT_INNER(a, b) a##b
+#define CPU_ZONE_CONCAT(a, b) CPU_ZONE_CONCAT_INNER(a, b)
+// Times the rest of the enclosing scope
+#define CPU_ZONE(name) CpuZone CPU_ZONE_CONCAT(cpuZone, __LINE__)(name)
+// Times one call at its call site, so overrides of a virtual step are timed too
+#define CPU_ZONE_CALL(name, ...) \
+  do                             \
+  {                              \
+    CPU_ZONE(name);              \
+    __VA_ARGS__;                 \
+  } while (0)
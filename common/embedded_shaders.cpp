@@ -0,0 +1,22 @@
+#include "embedded_shaders.h"
+
+#include <unordered_map>
+
+// Function-local so registrations from other translation units never run before it exists
+static std::unordered_map<std::string, EmbeddedShader> &embeddedShaders()
+{
+    static std::unordered_map<std::string, EmbeddedShader> shaders;
+    return shaders;
+}
+
+void registerEmbeddedShader(const char *name, const uint32_t *code, size_t size)
+{
+    embeddedShaders()[name] = EmbeddedShader{code, size};
+}
+
+const EmbeddedShader *findEmbeddedShader(const std::string &name)
+{
+    auto &shaders = embeddedShaders();
+    auto it = shaders.find(name);
+    return it != shaders.end() ? &it->second : nullptr;
+}
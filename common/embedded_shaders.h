@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// SPIR-V compiled at build time and linked into the example executable.
+//
+// add_example() in CMakeLists.txt compiles every file in the example's shaders/
+// folder with glslc and generates a source file that registers each blob here
+// under its file name (e.g. "shader.vert"). compileShader looks shaders up by
+// name before touching the disk or the runtime compiler.
+struct EmbeddedShader
+{
+  const uint32_t *code;
+  size_t size; // in bytes
+};
+
+// Returns the embedded SPIR-V for name, or nullptr if the shader wasn't embedded
+const EmbeddedShader *findEmbeddedShader(const std::string &name);
+
+void registerEmbeddedShader(const char *name, const uint32_t *code, size_t size);
+
+// Registers a shader during static initialization; used by the generated sources
+struct EmbeddedShaderRegistration
+{
+  EmbeddedShaderRegistration(const char *name, const uint32_t *code, size_t size)
+  {
+    registerEmbeddedShader(name, code, size);
+  }
+};
@@ -0,0 +1,165 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+    if (timerResolutionRaised)
+        timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::waitForNextFrame(float targetFPS)
+{
+    Clock::time_point now = Clock::now();
+    if (targetFPS <= 0.0f)
+    {
+        started = false;
+        recordInterval(now, false);
+        return;
+    }
+
+    auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFPS));
+    if (!started)
+    {
+        deadline = now;
+        started = true;
+#ifdef _WIN32
+        // Only raised once pacing is actually used; it costs power system-wide
+        if (!timerResolutionRaised)
+            timerResolutionRaised = timeBeginPeriod(1) == TIMERR_NOERROR;
+#endif
+    }
+    deadline += period;
+
+    bool missed = now > deadline;
+    if (now > deadline + period)
+    {
+        // Too late to keep the phase; the next deadline is measured from now
+        deadline = now;
+    }
+    else if (!missed)
+    {
+        Clock::duration spinMargin = getSpinMargin();
+        if (deadline - now > spinMargin)
+        {
+            sleepUntil(deadline - spinMargin);
+        }
+        while (Clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    recordInterval(Clock::now(), missed);
+}
+
+void FramePacer::sleepUntil(Clock::time_point wakeTime)
+{
+    std::this_thread::sleep_until(wakeTime);
+    Clock::duration overshoot = std::max(Clock::now() - wakeTime, Clock::duration::zero());
+
+    // Take a longer overshoot at once so the next deadline is not missed; let a shorter one
+    // pull the estimate down over roughly 64 sleeps
+    if (overshoot > sleepOvershoot)
+        sleepOvershoot = overshoot;
+    else
+        sleepOvershoot -= (sleepOvershoot - overshoot) / 64;
+}
+
+void FramePacer::recordInterval(Clock::time_point now, bool missed)
+{
+    Clock::time_point previous = lastFrame;
+    lastFrame = now;
+    if (previous == Clock::time_point())
+        return;
+
+    double intervalMs = std::chrono::duration<double, std::milli>(now - previous).count();
+    size_t bucket = std::min(static_cast<size_t>(intervalMs / FrameIntervalHistogram::BUCKET_WIDTH_MS),
+                             FrameIntervalHistogram::BUCKET_COUNT - 1);
+
+    // Evict the oldest interval once the window is full
+    if (histogram.sampleCount == FrameIntervalHistogram::WINDOW_SIZE)
+    {
+        histogram.buckets[windowBuckets[windowNext]]--;
+        if (windowMissed[windowNext])
+            histogram.missedDeadlines--;
+    }
+    else
+    {
+        histogram.sampleCount++;
+    }
+
+    windowBuckets[windowNext] = static_cast<uint8_t>(bucket);
+    windowMissed[windowNext] = missed;
+    windowNext = (windowNext + 1) % FrameIntervalHistogram::WINDOW_SIZE;
+
+    histogram.buckets[bucket]++;
+    histogram.totalFrames++;
+    if (missed)
+    {
+        histogram.missedDeadlines++;
+        histogram.totalMissedDeadlines++;
+    }
+}
+
+double FramePacer::getIntervalPercentileMs(double fraction) const
+{
+    if (histogram.sampleCount == 0)
+        return 0.0;
+
+    uint32_t target = static_cast<uint32_t>(fraction * histogram.sampleCount + 0.5);
+    uint32_t seen = 0;
+    for (size_t i = 0; i < FrameIntervalHistogram::BUCKET_COUNT; i++)
+    {
+        seen += histogram.buckets[i];
+        if (seen >= target && seen > 0)
+        {
+            // Upper edge of the bucket, so the result never understates the interval
+            return (i + 1) * FrameIntervalHistogram::BUCKET_WIDTH_MS;
+        }
+    }
+    return FrameIntervalHistogram::BUCKET_COUNT * FrameIntervalHistogram::BUCKET_WIDTH_MS;
+}
+
+void FramePacer::printSummary(std::ostream &out) const
+{
+    if (histogram.sampleCount == 0)
+        return;
+
+    std::ios savedFormat(nullptr);
+    savedFormat.copyfmt(out);
+    out << std::fixed << std::setprecision(1);
+    out << "Frame pacing: " << histogram.totalFrames << " frames, " << histogram.totalMissedDeadlines
+        << " missed deadlines; last " << histogram.sampleCount << " intervals p50 " << getIntervalPercentileMs(0.50)
+        << " ms, p99 " << getIntervalPercentileMs(0.99) << " ms, spin margin "
+        << std::chrono::duration<double, std::milli>(getSpinMargin()).count() << " ms" << std::endl;
+
+    uint32_t largest = *std::max_element(histogram.buckets.begin(), histogram.buckets.end());
+    for (size_t i = 0; i < FrameIntervalHistogram::BUCKET_COUNT; i++)
+    {
+        uint32_t count = histogram.buckets[i];
+        if (count == 0)
+            continue;
+        double lowMs = i * FrameIntervalHistogram::BUCKET_WIDTH_MS;
+        bool last = i == FrameIntervalHistogram::BUCKET_COUNT - 1;
+        out << std::setw(7) << lowMs << (last ? "+  ms " : "   ms ") << std::setw(5) << count << " "
+            << std::string((count * 40 + largest - 1) / largest, '#') << std::endl;
+    }
+    out.copyfmt(savedFormat);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Rolling histogram of the intervals between the last WINDOW_SIZE paced frames
+struct FrameIntervalHistogram
+{
+  static constexpr size_t BUCKET_COUNT = 128;
+  static constexpr double BUCKET_WIDTH_MS = 0.5;
+  static constexpr size_t WINDOW_SIZE = 256;
+
+  // Bucket i counts intervals in [i, i + 1) * BUCKET_WIDTH_MS; the last bucket also holds longer ones
+  std::array<uint32_t, BUCKET_COUNT> buckets{};
+  // Intervals currently in the window
+  uint32_t sampleCount = 0;
+  // Deadlines missed within the window, and since the pacer started
+  uint32_t missedDeadlines = 0;
+  uint64_t totalMissedDeadlines = 0;
+  uint64_t totalFrames = 0;
+};
+
+// Paces the frame loop to absolute deadlines.
+//
+// Each deadline is the previous one plus the frame period, so time spent in the
+// frame itself and oversleeping never accumulate into drift. The wait sleeps
+// until a spin margin before the deadline and yields in a loop for the rest.
+// The margin tracks how far sleeps actually overshoot, rising at once and
+// decaying slowly, so it absorbs the OS timer slack wherever it is. On Windows
+// the pacer raises the system timer resolution to 1 ms while it is pacing,
+// since the default 15.6 ms tick oversleeps most frame periods. A frame that
+// starts more than a whole period late drops its phase and restarts from now
+// instead of rushing to catch up.
+class FramePacer
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Margin before the first sleep has been measured
+  static constexpr Clock::duration INITIAL_SPIN_MARGIN = std::chrono::microseconds(2000);
+  // Headroom kept above the measured overshoot
+  static constexpr Clock::duration MIN_SPIN_MARGIN = std::chrono::microseconds(250);
+
+  FramePacer() = default;
+  ~FramePacer();
+  FramePacer(const FramePacer &) = delete;
+  FramePacer &operator=(const FramePacer &) = delete;
+
+  // Waits for the next deadline at targetFPS; when targetFPS is 0 it returns
+  // immediately and only records the interval.
+  void waitForNextFrame(float targetFPS);
+
+  const FrameIntervalHistogram &getHistogram() const { return histogram; }
+  // Interval below which the given fraction of the window's frames fall, e.g. 0.99
+  double getIntervalPercentileMs(double fraction) const;
+  void printSummary(std::ostream &out) const;
+  Clock::duration getSpinMargin() const { return sleepOvershoot + MIN_SPIN_MARGIN; }
+
+private:
+  void recordInterval(Clock::time_point now, bool missed);
+  // Sleeps until wakeTime and folds the overshoot into sleepOvershoot
+  void sleepUntil(Clock::time_point wakeTime);
+
+  FrameIntervalHistogram histogram;
+  // Ring of the window's bucket indices and missed flags, for eviction
+  std::array<uint8_t, FrameIntervalHistogram::WINDOW_SIZE> windowBuckets{};
+  std::array<bool, FrameIntervalHistogram::WINDOW_SIZE> windowMissed{};
+  size_t windowNext = 0;
+
+  Clock::time_point deadline;
+  Clock::time_point lastFrame;
+  bool started = false;
+
+  // Slow-decaying maximum of how late sleeps have woken up
+  Clock::duration sleepOvershoot = INITIAL_SPIN_MARGIN - MIN_SPIN_MARGIN;
+  // Set while timeBeginPeriod(1) is in effect on Windows
+  bool timerResolutionRaised = false;
+};
@@ -0,0 +1,86 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+FrameTimeSummary summarizeFrameTimes(std::vector<double> samples)
+{
+    FrameTimeSummary summary;
+    if (samples.empty())
+        return summary;
+
+    std::sort(samples.begin(), samples.end());
+    // Nearest-rank percentiles, so every reported value is a real sample
+    auto percentile = [&](double p)
+    {
+        size_t rank = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[std::min(rank, samples.size() - 1)];
+    };
+
+    summary.count = samples.size();
+    summary.min = samples.front();
+    summary.max = samples.back();
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.p99 = percentile(0.99);
+    return summary;
+}
+
+void FrameStats::addFrame(double frameMs, double cpuSubmitMs)
+{
+    this->frameMs.push_back(frameMs);
+    this->cpuSubmitMs.push_back(cpuSubmitMs);
+}
+
+void FrameStats::addGpuZones(const std::vector<GpuZoneResult> &zones)
+{
+    std::map<uint64_t, std::pair<double, double>> spans;
+    for (const GpuZoneResult &zone : zones)
+    {
+        auto [it, inserted] = spans.try_emplace(zone.frame, zone.startUs, zone.startUs + zone.durationUs);
+        if (!inserted)
+        {
+            it->second.first = std::min(it->second.first, zone.startUs);
+            it->second.second = std::max(it->second.second, zone.startUs + zone.durationUs);
+        }
+    }
+
+    for (const auto &[frame, span] : spans)
+    {
+        gpuMs.push_back((span.second - span.first) / 1000.0);
+    }
+}
+
+static void writeSummary(std::ostream &out, const char *name, const FrameTimeSummary &summary)
+{
+    out << "  \"" << name << "\": {\"count\": " << summary.count << ", \"min\": " << summary.min
+        << ", \"mean\": " << summary.mean << ", \"p50\": " << summary.p50 << ", \"p90\": " << summary.p90
+        << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max << "}";
+}
+
+void FrameStats::writeJson(const std::filesystem::path &path, const std::string &appName,
+                           const std::string &deviceName) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open stats file: " + path.string());
+    }
+
+    FrameTimeSummary frame = summarizeFrameTimes(frameMs);
+    file << std::fixed << std::setprecision(4);
+    file << "{\n  \"app\": \"" << appName << "\",\n  \"device\": \"" << deviceName << "\",\n";
+    file << "  \"frames\": " << frameMs.size() << ",\n";
+    file << "  \"fps\": " << (frame.mean > 0.0 ? 1000.0 / frame.mean : 0.0) << ",\n";
+    writeSummary(file, "frameMs", frame);
+    file << ",\n";
+    writeSummary(file, "cpuSubmitMs", summarizeFrameTimes(cpuSubmitMs));
+    file << ",\n";
+    writeSummary(file, "gpuMs", summarizeFrameTimes(gpuMs));
+    file << "\n}\n";
+}
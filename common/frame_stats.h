@@ -0,0 +1,43 @@
+#pragma once
+
+#include "gpu_profiler.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Distribution of one per-frame metric, in milliseconds
+struct FrameTimeSummary
+{
+  size_t count = 0;
+  double min = 0.0;
+  double mean = 0.0;
+  double p50 = 0.0;
+  double p90 = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+};
+
+FrameTimeSummary summarizeFrameTimes(std::vector<double> samples);
+
+// Per-frame timings written by --stats-json, the input of renderdoclab_bench.
+//
+// frameMs is the CPU interval between consecutive frames, cpuSubmitMs the time
+// spent recording and submitting a frame, and gpuMs the span of the frame's GPU
+// timestamp zones across all queues.
+class FrameStats
+{
+public:
+  void addFrame(double frameMs, double cpuSubmitMs);
+  // Derives gpuMs per frame from the profiler's zones
+  void addGpuZones(const std::vector<GpuZoneResult> &zones);
+
+  size_t getFrameCount() const { return frameMs.size(); }
+  FrameTimeSummary getFrameTimeSummary() const { return summarizeFrameTimes(frameMs); }
+  void writeJson(const std::filesystem::path &path, const std::string &appName, const std::string &deviceName) const;
+
+private:
+  std::vector<double> frameMs;
+  std::vector<double> cpuSubmitMs;
+  std::vector<double> gpuMs;
+};
@@ -0,0 +1,309 @@
+#include "gpu_profiler.h"
+#include "cpu_profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+static const char *queueName(GpuQueue queue)
+{
+    return queue == GpuQueue::Compute ? "compute" : "graphics";
+}
+
+// Zone names are expected to be identifiers, but keep the JSON valid regardless
+static std::string escapeJson(const char *text)
+{
+    std::string escaped;
+    for (const char *c = text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            escaped += '\\';
+        if (static_cast<unsigned char>(*c) >= 0x20)
+            escaped += *c;
+    }
+    return escaped;
+}
+
+void GpuProfiler::init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t frameCount,
+                       uint32_t graphicsQueueFamily, uint32_t computeQueueFamily)
+{
+    this->device = device;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    nsPerTick = properties.limits.timestampPeriod;
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+    // A family reporting 0 valid bits cannot write timestamps at all
+    auto maskFor = [&](uint32_t family)
+    {
+        uint32_t bits = families[family].timestampValidBits;
+        return bits >= 64 ? ~0ull : (1ull << bits) - 1;
+    };
+    timestampMask[static_cast<uint32_t>(GpuQueue::Graphics)] = maskFor(graphicsQueueFamily);
+    timestampMask[static_cast<uint32_t>(GpuQueue::Compute)] = maskFor(computeQueueFamily);
+
+    if (!queueHasTimestamps(GpuQueue::Graphics) && !queueHasTimestamps(GpuQueue::Compute))
+    {
+        std::cerr << "GPU profiler disabled: no queue supports timestamps" << std::endl;
+        return;
+    }
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = frameCount * MAX_ZONES_PER_FRAME * 2;
+
+    if (vkCreateQueryPool(device, &poolInfo, nullptr, &queryPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create timestamp query pool!");
+    }
+
+    frames.assign(frameCount, Frame{});
+    for (Frame &frame : frames)
+    {
+        frame.zones.reserve(MAX_ZONES_PER_FRAME);
+    }
+    currentFrame = 0;
+    frameCounter = 0;
+    resetPending = true;
+}
+
+void GpuProfiler::destroy()
+{
+    if (queryPool == VK_NULL_HANDLE)
+        return;
+
+    vkDestroyQueryPool(device, queryPool, nullptr);
+    queryPool = VK_NULL_HANDLE;
+    frames.clear();
+}
+
+void GpuProfiler::calibrate(VkQueue queue, VkCommandPool commandPool)
+{
+    if (!isEnabled())
+        return;
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = commandPool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    // Query 0 is reset again before the first frame uses it
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    vkCmdResetQueryPool(commandBuffer, queryPool, 0, 1);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 0);
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    double cpuBefore = profilerClockMicros();
+    vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(queue);
+    double cpuAfter = profilerClockMicros();
+
+    uint64_t ticks = 0;
+    vkGetQueryPoolResults(device, queryPool, 0, 1, sizeof(ticks), &ticks, sizeof(ticks),
+                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+    // The timestamp landed somewhere between submit and idle; take the midpoint
+    gpuEpochUs = (cpuBefore + cpuAfter) * 0.5 - static_cast<double>(ticks) * nsPerTick / 1000.0;
+
+    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+}
+
+void GpuProfiler::beginFrame(uint32_t frameIndex)
+{
+    if (!isEnabled())
+        return;
+
+    currentFrame = frameIndex;
+    Frame &frame = frames[frameIndex];
+    collectFrame(frame, frameIndex);
+    frame.frameNumber = frameCounter++;
+    resetPending = true;
+    openZones[0] = openZones[1] = 0;
+}
+
+bool GpuProfiler::recordReset(VkCommandBuffer commandBuffer)
+{
+    if (!isEnabled() || !resetPending)
+        return false;
+
+    vkCmdResetQueryPool(commandBuffer, queryPool, currentFrame * MAX_ZONES_PER_FRAME * 2, MAX_ZONES_PER_FRAME * 2);
+    resetPending = false;
+    return true;
+}
+
+uint32_t GpuProfiler::beginZone(VkCommandBuffer commandBuffer, const char *name, GpuQueue queue)
+{
+    if (!isEnabled() || !queueHasTimestamps(queue))
+        return INVALID_ZONE;
+
+    Frame &frame = frames[currentFrame];
+    if (frame.zones.size() >= MAX_ZONES_PER_FRAME)
+        return INVALID_ZONE;
+
+    uint32_t zone = static_cast<uint32_t>(frame.zones.size());
+    uint32_t &depth = openZones[static_cast<uint32_t>(queue)];
+    frame.zones.push_back({name, queue, depth++});
+
+    uint32_t query = (currentFrame * MAX_ZONES_PER_FRAME + zone) * 2;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, query);
+    return zone;
+}
+
+void GpuProfiler::endZone(VkCommandBuffer commandBuffer, uint32_t zone)
+{
+    if (zone == INVALID_ZONE)
+        return;
+
+    const Zone &z = frames[currentFrame].zones[zone];
+    openZones[static_cast<uint32_t>(z.queue)]--;
+
+    uint32_t query = (currentFrame * MAX_ZONES_PER_FRAME + zone) * 2 + 1;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, query);
+}
+
+void GpuProfiler::collectAll()
+{
+    for (uint32_t i = 0; i < frames.size(); i++)
+    {
+        collectFrame(frames[i], i);
+    }
+}
+
+void GpuProfiler::collectFrame(Frame &frame, uint32_t frameIndex)
+{
+    if (frame.zones.empty())
+        return;
+
+    // Each query yields its value followed by an availability word. Zones recorded into a
+    // command buffer that was never submitted stay unavailable and are skipped.
+    uint32_t queryCount = static_cast<uint32_t>(frame.zones.size()) * 2;
+    std::vector<uint64_t> data(queryCount * 2);
+    vkGetQueryPoolResults(device, queryPool, frameIndex * MAX_ZONES_PER_FRAME * 2, queryCount,
+                          data.size() * sizeof(uint64_t), data.data(), 2 * sizeof(uint64_t),
+                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    for (size_t i = 0; i < frame.zones.size(); i++)
+    {
+        const Zone &zone = frame.zones[i];
+        uint64_t begin = data[i * 4];
+        uint64_t end = data[i * 4 + 2];
+        if (data[i * 4 + 1] == 0 || data[i * 4 + 3] == 0)
+            continue;
+
+        if (results.size() >= MAX_RECORDED_ZONES)
+        {
+            droppedZones++;
+            continue;
+        }
+
+        uint64_t mask = timestampMask[static_cast<uint32_t>(zone.queue)];
+        GpuZoneResult result;
+        result.name = zone.name;
+        result.queue = zone.queue;
+        result.frame = frame.frameNumber;
+        result.depth = zone.depth;
+        result.startUs = gpuEpochUs + static_cast<double>(begin & mask) * nsPerTick / 1000.0;
+        result.durationUs = static_cast<double>((end - begin) & mask) * nsPerTick / 1000.0;
+        results.push_back(result);
+    }
+
+    frame.zones.clear();
+}
+
+bool GpuProfiler::queueHasTimestamps(GpuQueue queue) const
+{
+    return timestampMask[static_cast<uint32_t>(queue)] != 0;
+}
+
+void GpuProfiler::appendTraceEvents(std::vector<std::string> &events) const
+{
+    // pid 2 keeps the GPU rows apart from CPU threads when traces are merged
+    events.push_back("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"GPU\"}}");
+    events.push_back("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"graphics queue\"}}");
+    events.push_back("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":1,\"args\":{\"name\":\"compute queue\"}}");
+    for (const GpuZoneResult &result : results)
+    {
+        std::ostringstream out;
+        out.precision(3);
+        out << std::fixed << "{\"name\":\"" << escapeJson(result.name) << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":2,\"tid\":"
+            << static_cast<uint32_t>(result.queue) << ",\"ts\":" << result.startUs << ",\"dur\":" << result.durationUs
+            << ",\"args\":{\"frame\":" << result.frame << "}}";
+        events.push_back(out.str());
+    }
+}
+
+void GpuProfiler::writeChromeTrace(const std::filesystem::path &path) const
+{
+    std::vector<std::string> events;
+    appendTraceEvents(events);
+    writeTraceFile(path, events);
+}
+
+void GpuProfiler::writeCsv(const std::filesystem::path &path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open CSV file: " + path.string());
+    }
+
+    file << "frame,queue,zone,depth,start_us,duration_us\n";
+    file.precision(3);
+    file << std::fixed;
+    for (const GpuZoneResult &result : results)
+    {
+        file << result.frame << ',' << queueName(result.queue) << ',' << result.name << ',' << result.depth << ','
+             << result.startUs << ',' << result.durationUs << '\n';
+    }
+}
+
+void GpuProfiler::printSummary() const
+{
+    struct Stats
+    {
+        size_t count = 0;
+        double total = 0.0;
+        double max = 0.0;
+    };
+    std::map<std::string, Stats> byName;
+    for (const GpuZoneResult &result : results)
+    {
+        Stats &stats = byName[std::string(queueName(result.queue)) + "/" + result.name];
+        stats.count++;
+        stats.total += result.durationUs;
+        stats.max = std::max(stats.max, result.durationUs);
+    }
+
+    std::cout << "GPU zones (" << results.size() << " samples";
+    if (droppedZones > 0)
+        std::cout << ", " << droppedZones << " dropped";
+    std::cout << "):" << std::endl;
+    for (const auto &[name, stats] : byName)
+    {
+        std::cout << "  " << name << ": mean " << stats.total / stats.count << " us, max " << stats.max << " us over "
+                  << stats.count << " samples" << std::endl;
+    }
+}
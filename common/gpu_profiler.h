@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Queue a zone's command buffer is submitted to; each gets its own row in the trace
+enum class GpuQueue : uint32_t
+{
+  Graphics = 0,
+  Compute = 1,
+};
+
+// A zone measured on the GPU, converted to the CPU steady_clock timeline
+struct GpuZoneResult
+{
+  const char *name = nullptr;
+  GpuQueue queue = GpuQueue::Graphics;
+  uint64_t frame = 0;
+  // Number of enclosing zones on the same queue
+  uint32_t depth = 0;
+  // Microseconds on the steady_clock epoch, so GPU zones line up with CPU timestamps
+  double startUs = 0.0;
+  double durationUs = 0.0;
+};
+
+// Timestamp query profiler.
+//
+// Each frame in flight owns a range of a single VkQueryPool. Zones write a
+// timestamp at their start and end; beginFrame() reads back the range once the
+// frame's fence has signalled, so results arrive one frame-slot later and the
+// CPU never waits on the GPU. Zone names must outlive the profiler (string
+// literals). All calls are no-ops until init() succeeds.
+class GpuProfiler
+{
+public:
+  static constexpr uint32_t MAX_ZONES_PER_FRAME = 64;
+  static constexpr uint32_t INVALID_ZONE = UINT32_MAX;
+  // Results kept for export; later zones are counted but dropped
+  static constexpr size_t MAX_RECORDED_ZONES = 1 << 18;
+
+  // Disables itself when neither queue family supports timestamps
+  void init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t frameCount, uint32_t graphicsQueueFamily,
+            uint32_t computeQueueFamily);
+  void destroy();
+  bool isEnabled() const { return queryPool != VK_NULL_HANDLE; }
+
+  // Maps GPU ticks onto steady_clock by timing one timestamp submitted to queue
+  void calibrate(VkQueue queue, VkCommandPool commandPool);
+
+  // Collects frameIndex's results. Call only after that frame's fence has been waited on.
+  void beginFrame(uint32_t frameIndex);
+  // Resets the current frame's queries. Must be recorded, outside a render pass, in the
+  // first command buffer of the frame that is submitted; later calls in the frame do nothing.
+  bool recordReset(VkCommandBuffer commandBuffer);
+
+  uint32_t beginZone(VkCommandBuffer commandBuffer, const char *name, GpuQueue queue = GpuQueue::Graphics);
+  void endZone(VkCommandBuffer commandBuffer, uint32_t zone);
+
+  // Collects every frame slot. Call after vkDeviceWaitIdle.
+  void collectAll();
+
+  const std::vector<GpuZoneResult> &getResults() const { return results; }
+  // Appends serialized Chrome trace events; see writeTraceFile in cpu_profiler.h
+  void appendTraceEvents(std::vector<std::string> &events) const;
+  void writeChromeTrace(const std::filesystem::path &path) const;
+  void writeCsv(const std::filesystem::path &path) const;
+  // Prints mean and max duration per zone name
+  void printSummary() const;
+
+private:
+  struct Zone
+  {
+    const char *name;
+    GpuQueue queue;
+    uint32_t depth;
+  };
+
+  struct Frame
+  {
+    uint64_t frameNumber = 0;
+    std::vector<Zone> zones;
+  };
+
+  void collectFrame(Frame &frame, uint32_t frameIndex);
+  bool queueHasTimestamps(GpuQueue queue) const;
+
+  VkDevice device = VK_NULL_HANDLE;
+  VkQueryPool queryPool = VK_NULL_HANDLE;
+  double nsPerTick = 1.0;
+  uint64_t timestampMask[2] = {0, 0};
+  // steady_clock microseconds at GPU tick 0
+  double gpuEpochUs = 0.0;
+
+  std::vector<Frame> frames;
+  uint32_t currentFrame = 0;
+  uint64_t frameCounter = 0;
+  bool resetPending = false;
+  uint32_t openZones[2] = {0, 0};
+
+  std::vector<GpuZoneResult> results;
+  size_t droppedZones = 0;
+};
+
+// Scoped zone. The command buffer must still be recording when it goes out of scope.
+class GpuZone
+{
+public:
+  GpuZone(GpuProfiler &profiler, VkCommandBuffer commandBuffer, const char *name,
+          GpuQueue queue = GpuQueue::Graphics)
+      : profiler(profiler), commandBuffer(commandBuffer), zone(profiler.beginZone(commandBuffer, name, queue))
+  {
+  }
+  ~GpuZone() { profiler.endZone(commandBuffer, zone); }
+
+  GpuZone(const GpuZone &) = delete;
+  GpuZone &operator=(const GpuZone &) = delete;
+
+private:
+  GpuProfiler &profiler;
+  VkCommandBuffer commandBuffer;
+  uint32_t zone;
+};
@@ -0,0 +1,356 @@
+#include "job_system.h"
+
+#include "cpu_profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+// The job system and worker index of the calling thread, so jobs scheduled from a
+// worker go to its own deque
+static thread_local const JobSystem *currentJobSystem = nullptr;
+static thread_local uint32_t currentWorkerIndex = 0;
+
+void JobSystem::init(uint32_t workerCount)
+{
+    stopping = false;
+    statsStart = std::chrono::steady_clock::now();
+
+    // Every worker must exist before any thread starts stealing from the others
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+    }
+}
+
+void JobSystem::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::unique_ptr<Worker> &worker : workers)
+    {
+        worker->thread.join();
+    }
+    workers.clear();
+
+    // Without workers, jobs nobody waited for are still pending; run them here
+    bool stolen = false;
+    while (JobHandle job = takeJob(stolen))
+    {
+        execute(job);
+    }
+}
+
+JobHandle JobSystem::schedule(std::function<void()> function, const std::vector<JobHandle> &dependencies)
+{
+    JobHandle job = std::make_shared<Job>();
+    job->function = std::move(function);
+
+    for (const JobHandle &dependency : dependencies)
+    {
+        std::lock_guard<std::mutex> dependencyLock(dependency->mutex);
+        if (dependency->isDone())
+        {
+            if (dependency->error)
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (!job->error)
+                    job->error = dependency->error;
+            }
+        }
+        else
+        {
+            job->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+            dependency->continuations.push_back(job);
+        }
+    }
+
+    // Drop the registration guard; the last finished dependency enqueues the job otherwise
+    if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        enqueue(job);
+    }
+    return job;
+}
+
+void JobSystem::wait(const JobHandle &job)
+{
+    while (!job->isDone())
+    {
+        bool stolen = false;
+        if (JobHandle next = takeJob(stolen))
+        {
+            execute(next);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        finishedCondition.wait(lock, [&]
+                               { return job->isDone() || queuedJobs.load() > 0; });
+    }
+
+    std::lock_guard<std::mutex> lock(job->mutex);
+    if (job->error)
+    {
+        std::rethrow_exception(job->error);
+    }
+}
+
+void JobSystem::waitAll(const std::vector<JobHandle> &jobs)
+{
+    // Every job is waited for before rethrowing, since they may reference the caller's stack
+    std::exception_ptr firstError;
+    for (const JobHandle &job : jobs)
+    {
+        try
+        {
+            wait(job);
+        }
+        catch (...)
+        {
+            if (!firstError)
+                firstError = std::current_exception();
+        }
+    }
+    if (firstError)
+    {
+        std::rethrow_exception(firstError);
+    }
+}
+
+void JobSystem::parallelFor(uint32_t count, const std::function<void(uint32_t)> &function, uint32_t minBatchSize)
+{
+    if (count == 0)
+        return;
+
+    // A few batches per thread so stealing can even out uneven items
+    uint32_t threadCount = getWorkerCount() + 1;
+    uint32_t batchSize = std::max(std::max(minBatchSize, 1u), (count + threadCount * 4 - 1) / (threadCount * 4));
+
+    std::vector<JobHandle> jobs;
+    for (uint32_t first = 0; first < count; first += batchSize)
+    {
+        uint32_t end = std::min(count, first + batchSize);
+        jobs.push_back(schedule([&function, first, end]
+                                {
+                                    for (uint32_t i = first; i < end; i++)
+                                    {
+                                        function(i);
+                                    } }));
+    }
+    waitAll(jobs);
+}
+
+std::vector<JobWorkerStats> JobSystem::getWorkerStats() const
+{
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - statsStart).count();
+
+    std::vector<JobWorkerStats> stats;
+    for (const std::unique_ptr<Worker> &worker : workers)
+    {
+        JobWorkerStats entry;
+        entry.jobsExecuted = worker->jobsExecuted.load();
+        entry.jobsStolen = worker->jobsStolen.load();
+        entry.busyMs = worker->busyNs.load() / 1e6;
+        entry.utilization = elapsedMs > 0.0 ? entry.busyMs / elapsedMs : 0.0;
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+void JobSystem::resetStats()
+{
+    for (std::unique_ptr<Worker> &worker : workers)
+    {
+        worker->jobsExecuted = 0;
+        worker->jobsStolen = 0;
+        worker->busyNs = 0;
+    }
+    statsStart = std::chrono::steady_clock::now();
+}
+
+void JobSystem::printUtilization(std::ostream &out) const
+{
+    std::vector<JobWorkerStats> stats = getWorkerStats();
+    uint64_t executed = 0;
+    uint64_t stolen = 0;
+    for (const JobWorkerStats &entry : stats)
+    {
+        executed += entry.jobsExecuted;
+        stolen += entry.jobsStolen;
+    }
+
+    std::ios savedFormat(nullptr);
+    savedFormat.copyfmt(out);
+    out << std::fixed << std::setprecision(0);
+    out << "Job system: " << stats.size() << " workers ran " << executed << " jobs (" << stolen
+        << " stolen), utilization";
+    for (const JobWorkerStats &entry : stats)
+    {
+        out << " " << entry.utilization * 100.0 << "%";
+    }
+    out << std::endl;
+    out.copyfmt(savedFormat);
+}
+
+void JobSystem::workerLoop(uint32_t workerIndex)
+{
+    currentJobSystem = this;
+    currentWorkerIndex = workerIndex;
+    CpuProfiler::setThreadName("job worker " + std::to_string(workerIndex));
+    Worker &worker = *workers[workerIndex];
+
+    while (true)
+    {
+        bool stolen = false;
+        if (JobHandle job = takeJob(stolen))
+        {
+            auto start = std::chrono::steady_clock::now();
+            execute(job);
+            auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            worker.busyNs.fetch_add(busy.count(), std::memory_order_relaxed);
+            worker.jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+            if (stolen)
+                worker.jobsStolen.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this]
+                           { return stopping || queuedJobs.load() > 0; });
+        if (stopping && queuedJobs.load() == 0)
+            return;
+    }
+}
+
+void JobSystem::enqueue(JobHandle job)
+{
+    {
+        // Counting under wakeMutex means a worker checking queuedJobs can't miss the wakeup
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        if (currentJobSystem == this)
+        {
+            Worker &worker = *workers[currentWorkerIndex];
+            std::lock_guard<std::mutex> queueLock(worker.mutex);
+            worker.queue.push_back(std::move(job));
+        }
+        else
+        {
+            std::lock_guard<std::mutex> queueLock(sharedMutex);
+            sharedQueue.push_back(std::move(job));
+        }
+        queuedJobs.fetch_add(1);
+    }
+    wakeCondition.notify_one();
+    // Threads blocked in wait() help with queued jobs too
+    finishedCondition.notify_all();
+}
+
+JobHandle JobSystem::takeJob(bool &stolen)
+{
+    JobHandle job;
+    bool isWorker = currentJobSystem == this;
+    stolen = false;
+
+    if (isWorker)
+    {
+        Worker &worker = *workers[currentWorkerIndex];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.queue.empty())
+        {
+            job = std::move(worker.queue.back());
+            worker.queue.pop_back();
+        }
+    }
+
+    if (!job)
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        if (!sharedQueue.empty())
+        {
+            job = std::move(sharedQueue.front());
+            sharedQueue.pop_front();
+        }
+    }
+
+    // Steal the oldest job of another worker, starting after our own index so thieves spread out
+    size_t workerCount = workers.size();
+    for (size_t i = 1; !job && i <= workerCount; i++)
+    {
+        size_t victimIndex = (currentWorkerIndex + i) % workerCount;
+        if (isWorker && victimIndex == currentWorkerIndex)
+            continue;
+
+        Worker &victim = *workers[victimIndex];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty())
+        {
+            job = std::move(victim.queue.front());
+            victim.queue.pop_front();
+            stolen = true;
+        }
+    }
+
+    if (job)
+    {
+        queuedJobs.fetch_sub(1);
+    }
+    return job;
+}
+
+void JobSystem::execute(const JobHandle &job)
+{
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        error = job->error;
+    }
+
+    if (!error)
+    {
+        try
+        {
+            job->function();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+    }
+    // Release whatever the function captured as soon as it has run
+    job->function = nullptr;
+
+    std::vector<JobHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->error = error;
+        job->done.store(true, std::memory_order_release);
+        continuations.swap(job->continuations);
+    }
+
+    for (const JobHandle &continuation : continuations)
+    {
+        if (error)
+        {
+            std::lock_guard<std::mutex> lock(continuation->mutex);
+            if (!continuation->error)
+                continuation->error = error;
+        }
+        if (continuation->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            enqueue(continuation);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    finishedCondition.notify_all();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// A scheduled job. Hold on to the handle to wait for it or to make other jobs depend on it.
+class Job
+{
+public:
+  bool isDone() const { return done.load(std::memory_order_acquire); }
+
+private:
+  friend class JobSystem;
+
+  std::function<void()> function;
+  // Unfinished dependencies, plus one while schedule() is still registering them
+  std::atomic<uint32_t> pendingDependencies{1};
+  std::atomic<bool> done{false};
+  // Guards continuations, error and the transition to done
+  std::mutex mutex;
+  std::vector<std::shared_ptr<Job>> continuations;
+  // Set when the job or one of its dependencies threw; the job's function is then skipped
+  std::exception_ptr error;
+};
+
+using JobHandle = std::shared_ptr<Job>;
+
+// Per-worker counters since init() or the last resetStats()
+struct JobWorkerStats
+{
+  uint64_t jobsExecuted = 0;
+  // Jobs taken from another worker's queue
+  uint64_t jobsStolen = 0;
+  double busyMs = 0.0;
+  // busyMs as a fraction of the time since the counters were reset
+  double utilization = 0.0;
+};
+
+// Work-stealing thread pool.
+//
+// Every worker owns a deque: jobs scheduled from a worker are pushed to the back
+// of its own deque and popped from there (newest first, while its data is still
+// in cache), and idle workers steal the oldest jobs from the front of the others.
+// Jobs scheduled from other threads go to a shared queue. Threads that wait on a
+// job run queued jobs in the meantime, so fork/join from inside a job never
+// deadlocks. With zero workers everything runs on the waiting thread.
+class JobSystem
+{
+public:
+  ~JobSystem() { shutdown(); }
+
+  void init(uint32_t workerCount);
+  // Finishes queued jobs, then joins the workers
+  void shutdown();
+  uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+  // Runs function once every dependency has finished. If a dependency threw, function is
+  // skipped and waiting on the returned job rethrows that exception.
+  JobHandle schedule(std::function<void()> function, const std::vector<JobHandle> &dependencies = {});
+  // Runs queued jobs until job has finished, then rethrows its exception, if any
+  void wait(const JobHandle &job);
+  void waitAll(const std::vector<JobHandle> &jobs);
+
+  // Fork/join: calls function(i) for every i in [0, count), in batches of at least
+  // minBatchSize, and returns once all calls have finished
+  void parallelFor(uint32_t count, const std::function<void(uint32_t)> &function, uint32_t minBatchSize = 1);
+
+  std::vector<JobWorkerStats> getWorkerStats() const;
+  void resetStats();
+  void printUtilization(std::ostream &out) const;
+
+private:
+  struct Worker
+  {
+    std::thread thread;
+    std::mutex mutex;
+    std::deque<JobHandle> queue;
+    std::atomic<uint64_t> jobsExecuted{0};
+    std::atomic<uint64_t> jobsStolen{0};
+    std::atomic<uint64_t> busyNs{0};
+  };
+
+  void workerLoop(uint32_t workerIndex);
+  void enqueue(JobHandle job);
+  // Pops a job for the calling thread: its own queue, then the shared queue, then stealing
+  JobHandle takeJob(bool &stolen);
+  // Runs job, then marks it done and enqueues the dependents it was the last dependency of
+  void execute(const JobHandle &job);
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::mutex sharedMutex;
+  std::deque<JobHandle> sharedQueue;
+
+  // Sleeping workers wait on wakeMutex/wakeCondition for queuedJobs; waiters on
+  // finishedCondition are woken whenever a job completes
+  std::mutex wakeMutex;
+  std::condition_variable wakeCondition;
+  std::condition_variable finishedCondition;
+  std::atomic<uint32_t> queuedJobs{0};
+  bool stopping = false;
+
+  std::chrono::steady_clock::time_point statsStart;
+};
@@ -0,0 +1,373 @@
+#include "memory_allocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void MemoryAllocator::init(VkPhysicalDevice physicalDevice, VkDevice device, bool dedicatedAllocations)
+{
+    this->device = device;
+    this->dedicatedAllocations = dedicatedAllocations;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    // Host-visible VRAM on a discrete GPU is a PCIe window (often 256 MiB) better left to
+    // staging and per-frame data; elsewhere it is the same memory as everything else
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    unifiedMemoryTypeBits = 0;
+    if (properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+    {
+        VkMemoryPropertyFlags unified = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+        {
+            if ((memoryProperties.memoryTypes[i].propertyFlags & unified) == unified)
+            {
+                unifiedMemoryTypeBits |= 1u << i;
+            }
+        }
+    }
+}
+
+void MemoryAllocator::destroy()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Freeing memory implicitly unmaps it
+    for (auto &block : blocks)
+    {
+        if (block.memory != VK_NULL_HANDLE)
+        {
+            vkFreeMemory(device, block.memory, nullptr);
+        }
+    }
+    for (auto &[memory, size] : dedicatedMemory)
+    {
+        vkFreeMemory(device, memory, nullptr);
+    }
+
+    blocks.clear();
+    dedicatedMemory.clear();
+    bytesUsed = 0;
+    allocationCount = 0;
+}
+
+MemoryAllocation MemoryAllocator::allocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties)
+{
+    VkMemoryRequirements requirements;
+    bool dedicated = false;
+
+    if (dedicatedAllocations)
+    {
+        VkMemoryDedicatedRequirements dedicatedRequirements{};
+        dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+        VkMemoryRequirements2 requirements2{};
+        requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+        requirements2.pNext = &dedicatedRequirements;
+
+        VkBufferMemoryRequirementsInfo2 info{};
+        info.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+        info.buffer = buffer;
+        vkGetBufferMemoryRequirements2(device, &info, &requirements2);
+
+        requirements = requirements2.memoryRequirements;
+        dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+    }
+    else
+    {
+        vkGetBufferMemoryRequirements(device, buffer, &requirements);
+    }
+
+    // Device-local buffers prefer unified memory, which comes back mapped
+    if ((properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) && (requirements.memoryTypeBits & unifiedMemoryTypeBits))
+    {
+        requirements.memoryTypeBits &= unifiedMemoryTypeBits;
+    }
+
+    return allocate(requirements, properties, true, dedicated, dedicated ? buffer : VK_NULL_HANDLE, VK_NULL_HANDLE);
+}
+
+MemoryAllocation MemoryAllocator::allocateForImage(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags properties)
+{
+    VkMemoryRequirements requirements;
+    bool dedicated = false;
+
+    if (dedicatedAllocations)
+    {
+        VkMemoryDedicatedRequirements dedicatedRequirements{};
+        dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+        VkMemoryRequirements2 requirements2{};
+        requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+        requirements2.pNext = &dedicatedRequirements;
+
+        VkImageMemoryRequirementsInfo2 info{};
+        info.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+        info.image = image;
+        vkGetImageMemoryRequirements2(device, &info, &requirements2);
+
+        requirements = requirements2.memoryRequirements;
+        dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+    }
+    else
+    {
+        vkGetImageMemoryRequirements(device, image, &requirements);
+    }
+
+    bool linear = tiling == VK_IMAGE_TILING_LINEAR;
+    return allocate(requirements, properties, linear, dedicated, VK_NULL_HANDLE, dedicated ? image : VK_NULL_HANDLE);
+}
+
+MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties,
+                                           bool linear, bool dedicated, VkBuffer dedicatedBuffer, VkImage dedicatedImage)
+{
+    uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+    VkDeviceSize blockSize = blockSizeFor(memoryType);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    MemoryAllocation allocation{};
+    allocation.size = requirements.size;
+
+    // Resources the driver wants to own, and anything that would not fit in a block,
+    // get their own VkDeviceMemory
+    if (dedicated || requirements.size > blockSize / 2)
+    {
+        allocation.memory = allocateDeviceMemory(requirements.size, memoryType, dedicatedBuffer, dedicatedImage, &allocation.mapped);
+        allocation.block = MemoryAllocation::DEDICATED;
+        dedicatedMemory[allocation.memory] = requirements.size;
+        bytesUsed += requirements.size;
+        allocationCount++;
+        return allocation;
+    }
+
+    auto place = [&](uint32_t blockIndex) -> bool
+    {
+        Block &block = blocks[blockIndex];
+        VkDeviceSize offset;
+        if (!allocateFromBlock(block, requirements, offset))
+            return false;
+
+        allocation.memory = block.memory;
+        allocation.offset = offset;
+        allocation.block = blockIndex;
+        if (block.mapped)
+        {
+            allocation.mapped = static_cast<char *>(block.mapped) + offset;
+        }
+        block.allocationCount++;
+        bytesUsed += requirements.size;
+        allocationCount++;
+        return true;
+    };
+
+    for (uint32_t i = 0; i < blocks.size(); i++)
+    {
+        const Block &block = blocks[i];
+        if (block.memory != VK_NULL_HANDLE && block.memoryType == memoryType && block.linear == linear && place(i))
+        {
+            return allocation;
+        }
+    }
+
+    // No existing block has room; reuse a released slot or append a new one
+    Block block;
+    block.size = blockSize;
+    block.memoryType = memoryType;
+    block.linear = linear;
+    block.memory = allocateDeviceMemory(blockSize, memoryType, VK_NULL_HANDLE, VK_NULL_HANDLE, &block.mapped);
+    block.freeRanges.push_back({0, blockSize});
+
+    auto slot = std::find_if(blocks.begin(), blocks.end(), [](const Block &b)
+                             { return b.memory == VK_NULL_HANDLE; });
+    uint32_t blockIndex = static_cast<uint32_t>(slot - blocks.begin());
+    if (slot == blocks.end())
+    {
+        blocks.push_back(std::move(block));
+    }
+    else
+    {
+        *slot = std::move(block);
+    }
+
+    place(blockIndex);
+    return allocation;
+}
+
+bool MemoryAllocator::allocateFromBlock(Block &block, const VkMemoryRequirements &requirements, VkDeviceSize &offset)
+{
+    // First fit. Alignment padding in front of the allocation stays in the free list.
+    for (size_t i = 0; i < block.freeRanges.size(); i++)
+    {
+        FreeRange range = block.freeRanges[i];
+        VkDeviceSize alignedOffset = alignUp(range.offset, requirements.alignment);
+        VkDeviceSize rangeEnd = range.offset + range.size;
+        if (alignedOffset + requirements.size > rangeEnd)
+            continue;
+
+        offset = alignedOffset;
+        block.freeRanges.erase(block.freeRanges.begin() + i);
+
+        VkDeviceSize allocationEnd = alignedOffset + requirements.size;
+        if (allocationEnd < rangeEnd)
+        {
+            block.freeRanges.insert(block.freeRanges.begin() + i, {allocationEnd, rangeEnd - allocationEnd});
+        }
+        if (alignedOffset > range.offset)
+        {
+            block.freeRanges.insert(block.freeRanges.begin() + i, {range.offset, alignedOffset - range.offset});
+        }
+        return true;
+    }
+    return false;
+}
+
+void MemoryAllocator::free(MemoryAllocation &allocation)
+{
+    if (allocation.memory == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    bytesUsed -= allocation.size;
+    allocationCount--;
+
+    if (allocation.block == MemoryAllocation::DEDICATED)
+    {
+        vkFreeMemory(device, allocation.memory, nullptr);
+        dedicatedMemory.erase(allocation.memory);
+        allocation = MemoryAllocation{};
+        return;
+    }
+
+    Block &block = blocks[allocation.block];
+    auto &ranges = block.freeRanges;
+
+    // Insert in offset order and merge with the neighbours on either side
+    auto next = std::lower_bound(ranges.begin(), ranges.end(), allocation.offset, [](const FreeRange &r, VkDeviceSize offset)
+                                 { return r.offset < offset; });
+    auto it = ranges.insert(next, {allocation.offset, allocation.size});
+    if (it + 1 != ranges.end() && it->offset + it->size == (it + 1)->offset)
+    {
+        it->size += (it + 1)->size;
+        ranges.erase(it + 1);
+    }
+    if (it != ranges.begin() && (it - 1)->offset + (it - 1)->size == it->offset)
+    {
+        (it - 1)->size += it->size;
+        ranges.erase(it);
+    }
+
+    block.allocationCount--;
+
+    // Release an empty block unless it is the last one for its memory type
+    if (block.allocationCount == 0)
+    {
+        bool hasSibling = std::any_of(blocks.begin(), blocks.end(), [&](const Block &b)
+                                      { return &b != &block && b.memory != VK_NULL_HANDLE &&
+                                               b.memoryType == block.memoryType && b.linear == block.linear; });
+        if (hasSibling)
+        {
+            vkFreeMemory(device, block.memory, nullptr);
+            block = Block{};
+        }
+    }
+
+    allocation = MemoryAllocation{};
+}
+
+MemoryStats MemoryAllocator::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    MemoryStats stats;
+    stats.dedicatedCount = static_cast<uint32_t>(dedicatedMemory.size());
+    stats.allocationCount = allocationCount;
+    stats.bytesUsed = bytesUsed;
+
+    VkDeviceSize totalFree = 0;
+    for (const auto &block : blocks)
+    {
+        if (block.memory == VK_NULL_HANDLE)
+            continue;
+
+        stats.blockCount++;
+        stats.bytesReserved += block.size;
+        for (const auto &range : block.freeRanges)
+        {
+            stats.freeRangeCount++;
+            stats.largestFreeRange = std::max(stats.largestFreeRange, range.size);
+            totalFree += range.size;
+        }
+    }
+    for (const auto &[memory, size] : dedicatedMemory)
+    {
+        stats.bytesReserved += size;
+    }
+
+    if (totalFree > 0)
+    {
+        stats.fragmentation = 1.0f - static_cast<float>(stats.largestFreeRange) / static_cast<float>(totalFree);
+    }
+    return stats;
+}
+
+VkDeviceMemory MemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, VkBuffer dedicatedBuffer,
+                                                     VkImage dedicatedImage, void **mapped)
+{
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+    if (dedicatedBuffer != VK_NULL_HANDLE || dedicatedImage != VK_NULL_HANDLE)
+    {
+        dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+        dedicatedInfo.buffer = dedicatedBuffer;
+        dedicatedInfo.image = dedicatedImage;
+        allocInfo.pNext = &dedicatedInfo;
+    }
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate device memory!");
+    }
+
+    *mapped = nullptr;
+    if (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS)
+        {
+            vkFreeMemory(device, memory, nullptr);
+            throw std::runtime_error("Failed to map device memory!");
+        }
+    }
+    return memory;
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+VkDeviceSize MemoryAllocator::blockSizeFor(uint32_t memoryType) const
+{
+    // Small heaps (e.g. the 256 MiB BAR window) get proportionally smaller blocks
+    VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryType].heapIndex].size;
+    return std::min(DEFAULT_BLOCK_SIZE, heapSize / 8);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// A range of device memory handed out by MemoryAllocator. Resources are bound at
+// (memory, offset); several allocations usually share the same VkDeviceMemory.
+struct MemoryAllocation
+{
+  static constexpr uint32_t DEDICATED = UINT32_MAX;
+
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;
+  // Persistently mapped pointer for host-visible memory, otherwise nullptr
+  void *mapped = nullptr;
+  // Index of the owning block, or DEDICATED when the allocation has its own VkDeviceMemory
+  uint32_t block = DEDICATED;
+};
+
+struct MemoryStats
+{
+  uint32_t blockCount = 0;
+  uint32_t dedicatedCount = 0;
+  uint32_t allocationCount = 0;
+  // Total size of every VkDeviceMemory the allocator owns
+  VkDeviceSize bytesReserved = 0;
+  VkDeviceSize bytesUsed = 0;
+  uint32_t freeRangeCount = 0;
+  VkDeviceSize largestFreeRange = 0;
+  // 0 when all free block space is one contiguous range, approaching 1 as it splinters
+  float fragmentation = 0.0f;
+};
+
+// Sub-allocating device memory allocator.
+//
+// Memory is reserved in large blocks per memory type and carved into aligned
+// ranges using a first-fit free list, so resource count no longer drives the
+// number of vkAllocateMemory calls. Buffers and optimally tiled images live in
+// separate blocks, which keeps bufferImageGranularity from ever applying.
+// Resources the driver prefers to own (VK_KHR_dedicated_allocation) and
+// anything larger than a block get their own VkDeviceMemory. Host-visible
+// memory is mapped once for its whole lifetime.
+//
+// On unified-memory devices (integrated and software GPUs), device-local buffers
+// are placed in memory that is host-visible as well, so their allocation comes
+// back mapped and can be written without a staging copy.
+class MemoryAllocator
+{
+public:
+  static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+  // dedicatedAllocations requires Vulkan 1.1 (vkGet*MemoryRequirements2)
+  void init(VkPhysicalDevice physicalDevice, VkDevice device, bool dedicatedAllocations);
+  // Frees every block. All resources bound to allocator memory must be destroyed first.
+  void destroy();
+
+  MemoryAllocation allocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties);
+  MemoryAllocation allocateForImage(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags properties);
+  void free(MemoryAllocation &allocation);
+
+  MemoryStats getStats() const;
+  // Whether device-local buffer allocations are host-visible and mapped
+  bool hasUnifiedMemory() const { return unifiedMemoryTypeBits != 0; }
+
+private:
+  struct FreeRange
+  {
+    VkDeviceSize offset;
+    VkDeviceSize size;
+  };
+
+  struct Block
+  {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    void *mapped = nullptr;
+    uint32_t memoryType = 0;
+    bool linear = true;
+    uint32_t allocationCount = 0;
+    // Sorted by offset; adjacent ranges are merged on free
+    std::vector<FreeRange> freeRanges;
+  };
+
+  MemoryAllocation allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties,
+                            bool linear, bool dedicated, VkBuffer dedicatedBuffer, VkImage dedicatedImage);
+  bool allocateFromBlock(Block &block, const VkMemoryRequirements &requirements, VkDeviceSize &offset);
+  VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, VkBuffer dedicatedBuffer,
+                                      VkImage dedicatedImage, void **mapped);
+  uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+  VkDeviceSize blockSizeFor(uint32_t memoryType) const;
+
+  VkDevice device = VK_NULL_HANDLE;
+  VkPhysicalDeviceMemoryProperties memoryProperties{};
+  bool dedicatedAllocations = false;
+  // Device-local, host-visible and coherent memory types, on devices without a separate VRAM heap
+  uint32_t unifiedMemoryTypeBits = 0;
+
+  // Released blocks keep their slot (with a null memory handle) so block indices stay valid
+  std::vector<Block> blocks;
+  // Dedicated allocations and their sizes
+  std::unordered_map<VkDeviceMemory, VkDeviceSize> dedicatedMemory;
+  VkDeviceSize bytesUsed = 0;
+  uint32_t allocationCount = 0;
+
+  mutable std::mutex mutex;
+};
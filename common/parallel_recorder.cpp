@@ -0,0 +1,184 @@
+#include "parallel_recorder.h"
+
+#include "cpu_profiler.h"
+
+#include <stdexcept>
+#include <string>
+
+void ParallelRecorder::init(VkDevice device, uint32_t queueFamily, uint32_t threadCount, uint32_t frameCount)
+{
+    this->device = device;
+    commandPools.resize(static_cast<size_t>(frameCount) * threadCount);
+    commandBuffers.resize(commandPools.size());
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamily;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    for (size_t i = 0; i < commandPools.size(); i++)
+    {
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPools[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create recording thread command pool!");
+        }
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = commandPools[i];
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffers[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to allocate secondary command buffer!");
+        }
+    }
+
+    this->threadCount = threadCount;
+    recordedBuffers.assign(threadCount, VK_NULL_HANDLE);
+    stopping = false;
+    for (uint32_t i = 1; i < threadCount; i++)
+    {
+        // Workers start from the current generation so a re-initialized recorder never replays the last job
+        workers.emplace_back(&ParallelRecorder::workerLoop, this, i, generation);
+    }
+}
+
+void ParallelRecorder::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+
+    // Destroying a pool frees its command buffer
+    for (VkCommandPool pool : commandPools)
+    {
+        vkDestroyCommandPool(device, pool, nullptr);
+    }
+    commandPools.clear();
+    commandBuffers.clear();
+    threadCount = 0;
+}
+
+const std::vector<VkCommandBuffer> &ParallelRecorder::record(uint32_t frameIndex,
+                                                             const VkCommandBufferInheritanceInfo &inheritance,
+                                                             uint32_t itemCount, const RecordFunction &recordFunction)
+{
+    results.clear();
+    if (threadCount == 0)
+        return results;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobFrame = frameIndex;
+        jobItemCount = itemCount;
+        jobInheritance = &inheritance;
+        jobRecord = &recordFunction;
+        jobError = nullptr;
+        pendingWorkers = threadCount - 1;
+        generation++;
+    }
+    workReady.notify_all();
+
+    try
+    {
+        recordRange(0);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobError = std::current_exception();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        workDone.wait(lock, [this]
+                      { return pendingWorkers == 0; });
+    }
+    if (jobError)
+    {
+        std::rethrow_exception(jobError);
+    }
+
+    for (VkCommandBuffer commandBuffer : recordedBuffers)
+    {
+        if (commandBuffer != VK_NULL_HANDLE)
+            results.push_back(commandBuffer);
+    }
+    return results;
+}
+
+void ParallelRecorder::workerLoop(uint32_t threadIndex, uint64_t startGeneration)
+{
+    CpuProfiler::setThreadName("recorder " + std::to_string(threadIndex));
+
+    uint64_t seenGeneration = startGeneration;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [&]
+                           { return stopping || generation != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = generation;
+        }
+
+        std::exception_ptr error;
+        try
+        {
+            recordRange(threadIndex);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error)
+            jobError = error;
+        if (--pendingWorkers == 0)
+            workDone.notify_one();
+    }
+}
+
+void ParallelRecorder::recordRange(uint32_t threadIndex)
+{
+    uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(jobItemCount) * threadIndex / threadCount);
+    uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(jobItemCount) * (threadIndex + 1) / threadCount);
+    recordedBuffers[threadIndex] = VK_NULL_HANDLE;
+    if (first == end)
+        return;
+
+    CPU_ZONE("recordSecondary");
+    size_t slot = static_cast<size_t>(jobFrame) * threadCount + threadIndex;
+    // The frame's fence has signalled, so nothing recorded from this pool is still executing
+    vkResetCommandPool(device, commandPools[slot], 0);
+
+    VkCommandBuffer commandBuffer = commandBuffers[slot];
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = jobInheritance;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to begin recording secondary command buffer!");
+    }
+
+    (*jobRecord)(commandBuffer, first, end - first);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to record secondary command buffer!");
+    }
+    recordedBuffers[threadIndex] = commandBuffer;
+}
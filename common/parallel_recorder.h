@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Records a frame's draws on several threads into secondary command buffers.
+//
+// Every thread owns one command pool per frame in flight, so recording takes no
+// locks and a frame's pools can be reset as soon as its fence has signalled. The
+// calling thread records the first range itself and threadCount - 1 persistent
+// workers record the rest. All calls are no-ops until init() succeeds.
+class ParallelRecorder
+{
+public:
+  // Records items [first, first + count) into a secondary command buffer that has already begun
+  using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)>;
+
+  void init(VkDevice device, uint32_t queueFamily, uint32_t threadCount, uint32_t frameCount);
+  void destroy();
+  bool isEnabled() const { return threadCount > 0; }
+  uint32_t getThreadCount() const { return threadCount; }
+
+  // Splits itemCount evenly across the threads and returns the recorded secondary command
+  // buffers in item order, ready for vkCmdExecuteCommands. Call only after frameIndex's fence
+  // has been waited on; an exception thrown by recordFunction on any thread is rethrown here.
+  const std::vector<VkCommandBuffer> &record(uint32_t frameIndex, const VkCommandBufferInheritanceInfo &inheritance,
+                                             uint32_t itemCount, const RecordFunction &recordFunction);
+
+private:
+  void workerLoop(uint32_t threadIndex, uint64_t startGeneration);
+  void recordRange(uint32_t threadIndex);
+
+  VkDevice device = VK_NULL_HANDLE;
+  uint32_t threadCount = 0;
+  // Indexed by frameIndex * threadCount + threadIndex
+  std::vector<VkCommandPool> commandPools;
+  std::vector<VkCommandBuffer> commandBuffers;
+  // Per thread: the buffer it recorded for the current job, or VK_NULL_HANDLE for an empty range
+  std::vector<VkCommandBuffer> recordedBuffers;
+  std::vector<VkCommandBuffer> results;
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable workReady;
+  std::condition_variable workDone;
+  uint64_t generation = 0;
+  uint32_t pendingWorkers = 0;
+  bool stopping = false;
+
+  // The job being recorded, valid while record() runs
+  uint32_t jobFrame = 0;
+  uint32_t jobItemCount = 0;
+  const VkCommandBufferInheritanceInfo *jobInheritance = nullptr;
+  const RecordFunction *jobRecord = nullptr;
+  std::exception_ptr jobError;
+};
@@ -0,0 +1,159 @@
+#include "shader_cache.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+static const uint32_t SPIRV_MAGIC = 0x07230203;
+
+// 64-bit FNV-1a
+static const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+static const uint64_t FNV_PRIME = 0x100000001b3ull;
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+ShaderCache::ShaderCache()
+    : ShaderCache(defaultDirectory())
+{
+}
+
+ShaderCache::ShaderCache(std::filesystem::path directory)
+    : directory(std::move(directory))
+{
+}
+
+std::filesystem::path ShaderCache::defaultDirectory()
+{
+    if (const char *dir = std::getenv("RENDERDOCLAB_SHADER_CACHE_DIR"))
+    {
+        if (dir[0] != '\0')
+        {
+            return std::filesystem::path(dir);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::path tempDir = std::filesystem::temp_directory_path(ec);
+    if (ec)
+    {
+        tempDir = std::filesystem::current_path();
+    }
+    return tempDir / "renderdoclab_shader_cache";
+}
+
+uint64_t ShaderCache::computeKey(const std::vector<char> &source, uint32_t stage, const std::string &compilerFlags)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = fnv1a(hash, source.data(), source.size());
+    hash = fnv1a(hash, &stage, sizeof(stage));
+    hash = fnv1a(hash, compilerFlags.data(), compilerFlags.size());
+    return hash;
+}
+
+std::filesystem::path ShaderCache::entryPath(uint64_t key) const
+{
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".spv";
+    return directory / name.str();
+}
+
+std::optional<std::vector<char>> ShaderCache::load(uint64_t key)
+{
+    std::ifstream file(entryPath(key), std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        misses++;
+        return std::nullopt;
+    }
+
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+
+    // Treat truncated or foreign files as a miss; they get overwritten on store
+    uint32_t magic = 0;
+    if (!file || fileSize < sizeof(magic) || fileSize % sizeof(uint32_t) != 0)
+    {
+        misses++;
+        return std::nullopt;
+    }
+    std::memcpy(&magic, buffer.data(), sizeof(magic));
+    if (magic != SPIRV_MAGIC)
+    {
+        misses++;
+        return std::nullopt;
+    }
+
+    hits++;
+    return buffer;
+}
+
+static long currentProcessId()
+{
+#ifdef _WIN32
+    return static_cast<long>(_getpid());
+#else
+    return static_cast<long>(getpid());
+#endif
+}
+
+void ShaderCache::store(uint64_t key, const std::vector<char> &spirv)
+{
+    static std::atomic<uint32_t> tempCounter{0};
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec)
+    {
+        std::cerr << "Shader cache: cannot create " << directory.string() << ": " << ec.message() << std::endl;
+        return;
+    }
+
+    // Unique per process, thread and call so concurrent writers, including other processes
+    // sharing the cache directory, never share a temp file
+    std::filesystem::path finalPath = entryPath(key);
+    std::filesystem::path tempPath = finalPath;
+    tempPath += ".tmp" + std::to_string(currentProcessId()) + "_" +
+                std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + "_" +
+                std::to_string(tempCounter++);
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(spirv.data(), spirv.size());
+        if (!file)
+        {
+            std::cerr << "Shader cache: failed to write " << tempPath.string() << std::endl;
+            file.close();
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath, finalPath, ec);
+    if (ec)
+    {
+        std::cerr << "Shader cache: failed to store " << finalPath.string() << ": " << ec.message() << std::endl;
+        std::filesystem::remove(tempPath, ec);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Content-addressed on-disk cache for compiled SPIR-V.
+//
+// Entries are keyed by a hash of the GLSL source, the shader stage and the
+// compiler settings, so editing a shader or changing how it is compiled
+// produces a new key instead of a stale hit. Entries are written to a
+// temporary file and renamed into place so concurrent processes never observe
+// a partially written file.
+class ShaderCache
+{
+public:
+  // Uses RENDERDOCLAB_SHADER_CACHE_DIR when set, otherwise a folder in the
+  // system temp directory.
+  ShaderCache();
+  explicit ShaderCache(std::filesystem::path directory);
+
+  static std::filesystem::path defaultDirectory();
+  static uint64_t computeKey(const std::vector<char> &source, uint32_t stage, const std::string &compilerFlags);
+
+  // Returns the cached SPIR-V for key, or nothing on a miss
+  std::optional<std::vector<char>> load(uint64_t key);
+  // Stores SPIR-V for key. Failures are reported but never fatal.
+  void store(uint64_t key, const std::vector<char> &spirv);
+
+  uint32_t getHits() const { return hits.load(); }
+  uint32_t getMisses() const { return misses.load(); }
+  const std::filesystem::path &getDirectory() const { return directory; }
+
+private:
+  std::filesystem::path entryPath(uint64_t key) const;
+
+  std::filesystem::path directory;
+  std::atomic<uint32_t> hits{0};
+  std::atomic<uint32_t> misses{0};
+};
@@ -0,0 +1,181 @@
+#include "startup_report.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+struct StartupChild
+{
+    std::string name;
+    double ms = 0.0;
+    uint32_t count = 0;
+};
+
+struct StartupStep
+{
+    std::string name;
+    double ms = 0.0;
+    std::vector<StartupChild> children;
+};
+
+static bool contains(const CpuZoneEvent &outer, const CpuZoneEvent &inner)
+{
+    return inner.startUs >= outer.startUs && inner.startUs + inner.durationUs <= outer.startUs + outer.durationUs;
+}
+
+std::string getStartupReportDestination()
+{
+    const char *value = std::getenv("RENDERDOCLAB_STARTUP_REPORT");
+    return value ? value : "";
+}
+
+void writeStartupReport(const std::string &destination, const std::string &appName,
+                        const std::vector<CpuZoneEvent> &events, const std::vector<CpuZoneEvent> &workerEvents)
+{
+    // Zones complete innermost first, so the last "init" is the outermost of the latest run
+    auto init = std::find_if(events.rbegin(), events.rend(), [](const CpuZoneEvent &event)
+                             { return std::strcmp(event.name, "init") == 0; });
+    if (init == events.rend())
+        return;
+
+    std::vector<StartupStep> steps;
+    for (const CpuZoneEvent &event : events)
+    {
+        if (event.depth == init->depth + 1 && contains(*init, event))
+        {
+            steps.push_back({event.name, event.durationUs / 1000.0, {}});
+
+            // Repeated children such as compileShader are folded together
+            std::map<std::string, StartupChild> children;
+            for (const CpuZoneEvent &child : events)
+            {
+                if (child.depth == event.depth + 1 && contains(event, child))
+                {
+                    StartupChild &entry = children[child.name];
+                    entry.name = child.name;
+                    entry.ms += child.durationUs / 1000.0;
+                    entry.count++;
+                }
+            }
+            for (auto &[name, child] : children)
+            {
+                steps.back().children.push_back(child);
+            }
+            std::sort(steps.back().children.begin(), steps.back().children.end(),
+                      [](const StartupChild &a, const StartupChild &b)
+                      { return a.ms > b.ms; });
+        }
+    }
+    std::sort(steps.begin(), steps.end(), [](const StartupStep &a, const StartupStep &b)
+              { return a.ms > b.ms; });
+
+    // Outermost worker zones only; nested ones are already part of their time
+    std::map<std::string, StartupChild> workerTotals;
+    for (const CpuZoneEvent &event : workerEvents)
+    {
+        if (event.depth == 0 && contains(*init, event))
+        {
+            StartupChild &entry = workerTotals[event.name];
+            entry.name = event.name;
+            entry.ms += event.durationUs / 1000.0;
+            entry.count++;
+        }
+    }
+    std::vector<StartupChild> workers;
+    for (auto &[name, worker] : workerTotals)
+    {
+        workers.push_back(worker);
+    }
+    std::sort(workers.begin(), workers.end(), [](const StartupChild &a, const StartupChild &b)
+              { return a.ms > b.ms; });
+
+    double totalMs = init->durationUs / 1000.0;
+    double instrumentedMs = 0.0;
+    for (const StartupStep &step : steps)
+    {
+        instrumentedMs += step.ms;
+    }
+    // Steps an example adds in its initVulkan override without zones of their own
+    double otherMs = std::max(0.0, totalMs - instrumentedMs);
+
+    bool toFile = destination.size() > 5 && destination.compare(destination.size() - 5, 5, ".json") == 0;
+    if (destination == "json" || toFile)
+    {
+        std::ostringstream json;
+        json << std::fixed << std::setprecision(3);
+        json << "{\"app\":\"" << appName << "\",\"totalMs\":" << totalMs << ",\"otherMs\":" << otherMs
+             << ",\"steps\":[";
+        for (size_t i = 0; i < steps.size(); i++)
+        {
+            const StartupStep &step = steps[i];
+            json << (i ? "," : "") << "\n  {\"name\":\"" << step.name << "\",\"ms\":" << step.ms << ",\"children\":[";
+            for (size_t j = 0; j < step.children.size(); j++)
+            {
+                const StartupChild &child = step.children[j];
+                json << (j ? "," : "") << "{\"name\":\"" << child.name << "\",\"ms\":" << child.ms
+                     << ",\"count\":" << child.count << "}";
+            }
+            json << "]}";
+        }
+        json << "\n],\"workers\":[";
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            const StartupChild &worker = workers[i];
+            json << (i ? "," : "") << "{\"name\":\"" << worker.name << "\",\"ms\":" << worker.ms
+                 << ",\"count\":" << worker.count << "}";
+        }
+        json << "]}\n";
+
+        if (!toFile)
+        {
+            std::cout << json.str();
+            return;
+        }
+
+        std::ofstream file(destination);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Failed to open startup report: " + destination);
+        }
+        file << json.str();
+        std::cout << "Startup report written to " << destination << std::endl;
+        return;
+    }
+
+    std::ios savedFormat(nullptr);
+    savedFormat.copyfmt(std::cout);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Startup report for " << appName << ": " << totalMs << " ms" << std::endl;
+    for (const StartupStep &step : steps)
+    {
+        std::cout << std::setw(10) << step.ms << " ms " << std::setw(6) << step.ms / totalMs * 100.0 << "%  "
+                  << step.name << std::endl;
+        for (const StartupChild &child : step.children)
+        {
+            std::cout << std::setw(30) << child.ms << " ms  " << child.name;
+            if (child.count > 1)
+                std::cout << " x" << child.count;
+            std::cout << std::endl;
+        }
+    }
+    std::cout << std::setw(10) << otherMs << " ms " << std::setw(6) << otherMs / totalMs * 100.0
+              << "%  (not instrumented)" << std::endl;
+    if (!workers.empty())
+    {
+        std::cout << "  On worker threads, overlapping the steps above:" << std::endl;
+        for (const StartupChild &worker : workers)
+        {
+            std::cout << std::setw(10) << worker.ms << " ms  " << worker.name;
+            if (worker.count > 1)
+                std::cout << " x" << worker.count;
+            std::cout << std::endl;
+        }
+    }
+    std::cout.copyfmt(savedFormat);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "cpu_profiler.h"
+
+#include <string>
+#include <vector>
+
+// Startup-time breakdown built from the CPU zones recorded during VulkanApp::init().
+//
+// Enabled with the RENDERDOCLAB_STARTUP_REPORT environment variable:
+//   json         print the report to stdout as JSON
+//   <path>.json  write the JSON report to path, e.g. to track regressions per example
+//   anything     print a text report sorted by step duration
+
+// Returns the RENDERDOCLAB_STARTUP_REPORT value, or an empty string when unset
+std::string getStartupReportDestination();
+
+// events must contain the completed "init" zone and the zones nested in it. Zones from
+// workerEvents that ran during init, such as shader compiles on the job system, are listed
+// separately since they overlap the main thread's steps.
+void writeStartupReport(const std::string &destination, const std::string &appName,
+                        const std::vector<CpuZoneEvent> &events, const std::vector<CpuZoneEvent> &workerEvents);
@@ -0,0 +1,532 @@
+#include "upload_batch.h"
+
+#include "cpu_profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Staging offsets are kept aligned for any texel size a copy may use
+static const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+// Everything a later submission on the owner queue may read an uploaded buffer with
+static const VkAccessFlags2 BUFFER_READ_ACCESS = VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT |
+                                                 VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT |
+                                                 VK_ACCESS_2_TRANSFER_READ_BIT;
+
+void UploadBatch::init(VkDevice device, MemoryAllocator &allocator, VkQueue queue, uint32_t queueFamily,
+                       uint32_t ownerQueueFamily, PFN_vkCmdPipelineBarrier2 pipelineBarrier2)
+{
+    this->device = device;
+    this->allocator = &allocator;
+    this->queue = queue;
+    this->queueFamily = queueFamily;
+    this->ownerQueueFamily = ownerQueueFamily;
+    this->pipelineBarrier2 = pipelineBarrier2;
+    pendingBarriers = BarrierBuilder(pipelineBarrier2);
+
+    // Every command buffer is recorded once and freed after its submission completes
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamily;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create upload command pool!");
+    }
+
+    if (transfersOwnership())
+    {
+        VkSemaphoreTypeCreateInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        timelineInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &timelineInfo;
+
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timelineSemaphore) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create upload timeline semaphore!");
+        }
+    }
+}
+
+void UploadBatch::destroy()
+{
+    if (commandPool == VK_NULL_HANDLE)
+        return;
+
+    // Anything recorded but never submitted is simply dropped
+    release(current);
+    current = Batch();
+    pendingBarriers.clear();
+    waitIdle();
+
+    for (VkFence fence : freeFences)
+    {
+        vkDestroyFence(device, fence, nullptr);
+    }
+    freeFences.clear();
+
+    // Nothing can use the uploads any more, so their ownership never needs to be acquired
+    acquireBuffers.clear();
+    acquireImages.clear();
+    acquireMipChains.clear();
+    if (timelineSemaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(device, timelineSemaphore, nullptr);
+        timelineSemaphore = VK_NULL_HANDLE;
+    }
+
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    commandPool = VK_NULL_HANDLE;
+}
+
+StagedData UploadBatch::stage(const void *data, VkDeviceSize size)
+{
+    if (commandPool == VK_NULL_HANDLE)
+        return StagedData();
+
+    StagingChunk *chunk = current.chunks.empty() ? nullptr : &current.chunks.back();
+    VkDeviceSize offset = chunk ? (chunk->head + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT : 0;
+    if (!chunk || offset + size > chunk->size)
+    {
+        // Uploads larger than a chunk get a staging buffer of their own
+        StagingChunk newChunk;
+        newChunk.size = std::max(STAGING_CHUNK_SIZE, size);
+
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = newChunk.size;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device, &bufferInfo, nullptr, &newChunk.buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create staging buffer!");
+        }
+
+        newChunk.allocation = allocator->allocateForBuffer(
+            newChunk.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        vkBindBufferMemory(device, newChunk.buffer, newChunk.allocation.memory, newChunk.allocation.offset);
+
+        current.chunks.push_back(newChunk);
+        chunk = &current.chunks.back();
+        offset = 0;
+    }
+
+    std::memcpy(static_cast<char *>(chunk->allocation.mapped) + offset, data, static_cast<size_t>(size));
+    chunk->head = offset + size;
+    bytesStaged += size;
+
+    StagedData staged;
+    staged.buffer = chunk->buffer;
+    staged.offset = offset;
+    staged.size = size;
+    return staged;
+}
+
+void UploadBatch::uploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset)
+{
+    StagedData staged = stage(data, size);
+    copyBuffer(staged.buffer, dstBuffer, size, staged.offset, dstOffset);
+}
+
+void UploadBatch::uploadBuffer(VkBuffer dstBuffer, const MemoryAllocation &dstAllocation, const void *data,
+                               VkDeviceSize size, VkDeviceSize dstOffset)
+{
+    if (dstAllocation.mapped == nullptr)
+    {
+        uploadBuffer(dstBuffer, data, size, dstOffset);
+        return;
+    }
+
+    // Coherent memory: the write is visible to every queue submission made after it
+    std::memcpy(static_cast<char *>(dstAllocation.mapped) + dstOffset, data, static_cast<size_t>(size));
+    bytesWrittenDirectly += size;
+}
+
+void UploadBatch::uploadImage(VkImage image, uint32_t width, uint32_t height, const void *data, VkDeviceSize size,
+                              uint32_t mipLevels)
+{
+    StagedData staged = stage(data, size);
+    transitionImageLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    copyBufferToImage(staged.buffer, staged.offset, image, width, height);
+
+    if (mipLevels <= 1)
+    {
+        transitionImageLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        return;
+    }
+
+    MipChain chain;
+    chain.image = image;
+    chain.width = width;
+    chain.height = height;
+    chain.mipLevels = mipLevels;
+
+    if (!transfersOwnership())
+    {
+        VkCommandBuffer commandBuffer = getCommandBuffer();
+        if (commandBuffer != VK_NULL_HANDLE)
+            recordMipChain(commandBuffer, pendingBarriers, chain);
+        return;
+    }
+
+    // Transfer queues cannot blit, so the image moves to the owner queue still in TRANSFER_DST_OPTIMAL
+    VkImageMemoryBarrier2 barrier =
+        BarrierBuilder::transitionBarrier(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                          BarrierBuilder::subresourceRange(VK_IMAGE_ASPECT_COLOR_BIT));
+    barrier.srcQueueFamilyIndex = queueFamily;
+    barrier.dstQueueFamilyIndex = ownerQueueFamily;
+    current.ownershipImages.push_back(barrier);
+    current.mipChains.push_back(chain);
+}
+
+void UploadBatch::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset,
+                             VkDeviceSize dstOffset)
+{
+    VkCommandBuffer commandBuffer = getCommandBuffer();
+    if (commandBuffer == VK_NULL_HANDLE)
+        return;
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = srcOffset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+
+    if (transfersOwnership())
+    {
+        VkBufferMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        // Buffers may be read by any stage, including compute work on the owner queue
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = BUFFER_READ_ACCESS;
+        barrier.srcQueueFamilyIndex = queueFamily;
+        barrier.dstQueueFamilyIndex = ownerQueueFamily;
+        barrier.buffer = dstBuffer;
+        barrier.offset = dstOffset;
+        barrier.size = size;
+        current.ownershipBuffers.push_back(barrier);
+    }
+}
+
+void UploadBatch::copyBufferToImage(VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image, uint32_t width,
+                                    uint32_t height)
+{
+    VkCommandBuffer commandBuffer = getCommandBuffer();
+    if (commandBuffer == VK_NULL_HANDLE)
+        return;
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = bufferOffset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+
+    vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
+void UploadBatch::transitionImageLayout(VkImage image, VkImageAspectFlags aspectMask, VkImageLayout oldLayout,
+                                        VkImageLayout newLayout)
+{
+    transitionImageLayout(image, oldLayout, newLayout, BarrierBuilder::subresourceRange(aspectMask));
+}
+
+void UploadBatch::transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                        const VkImageSubresourceRange &range)
+{
+    // Deferred transitions still need a submission to be acquired by
+    if (beginCommandBuffer() == VK_NULL_HANDLE)
+        return;
+
+    VkImageMemoryBarrier2 barrier = BarrierBuilder::transitionBarrier(image, oldLayout, newLayout, range);
+
+    // A transfer queue supports none of the stages that use the other layouts, so transitions
+    // into them run on the owner queue once the batch has completed
+    if (transfersOwnership() && newLayout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+    {
+        if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+        {
+            // Written here, so ownership moves with the transition
+            barrier.srcQueueFamilyIndex = queueFamily;
+            barrier.dstQueueFamilyIndex = ownerQueueFamily;
+        }
+        else if (oldLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+        {
+            throw std::runtime_error("Unsupported layout transition on the transfer queue!");
+        }
+        current.ownershipImages.push_back(barrier);
+        return;
+    }
+    if (transfersOwnership() && oldLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+    {
+        throw std::runtime_error("Unsupported layout transition on the transfer queue!");
+    }
+
+    pendingBarriers.image(barrier);
+}
+
+VkCommandBuffer UploadBatch::getCommandBuffer()
+{
+    VkCommandBuffer commandBuffer = beginCommandBuffer();
+    if (commandBuffer != VK_NULL_HANDLE)
+        pendingBarriers.flush(commandBuffer);
+    return commandBuffer;
+}
+
+VkCommandBuffer UploadBatch::beginCommandBuffer()
+{
+    if (commandPool == VK_NULL_HANDLE || current.commandBuffer != VK_NULL_HANDLE)
+        return current.commandBuffer;
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = commandPool;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(device, &allocInfo, &current.commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate upload command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(current.commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to begin recording upload command buffer!");
+    }
+    return current.commandBuffer;
+}
+
+uint64_t UploadBatch::submit()
+{
+    if (current.commandBuffer == VK_NULL_HANDLE)
+        return submitCount;
+
+    CPU_ZONE("uploadBatchSubmit");
+    uint64_t ticket = ++submitCount;
+    current.ticket = ticket;
+
+    // Trailing transitions go out together with the release or the final barrier
+    if (transfersOwnership())
+    {
+        // Release half of each ownership transfer: the acquire's barrier, without its destination
+        for (VkBufferMemoryBarrier2 barrier : current.ownershipBuffers)
+        {
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_NONE;
+            pendingBarriers.buffer(barrier);
+        }
+        for (VkImageMemoryBarrier2 barrier : current.ownershipImages)
+        {
+            // Transitions out of UNDEFINED have nothing to release
+            if (barrier.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED)
+                continue;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_NONE;
+            pendingBarriers.image(barrier);
+        }
+    }
+    else
+    {
+        // Later submissions to the queue may read anything written here, whatever stage they read it in
+        pendingBarriers.memory(VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                               VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, BUFFER_READ_ACCESS);
+    }
+    pendingBarriers.flush(current.commandBuffer);
+
+    if (vkEndCommandBuffer(current.commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to record upload command buffer!");
+    }
+
+    if (!freeFences.empty())
+    {
+        current.fence = freeFences.back();
+        freeFences.pop_back();
+    }
+    else
+    {
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkCreateFence(device, &fenceInfo, nullptr, &current.fence) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create upload fence!");
+        }
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &current.commandBuffer;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &ticket;
+    if (transfersOwnership())
+    {
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &timelineSemaphore;
+    }
+
+    if (vkQueueSubmit(queue, 1, &submitInfo, current.fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to submit upload command buffer!");
+    }
+
+    submitted.push_back(std::move(current));
+    current = Batch();
+    // On the owner queue itself, anything submitted after this sees the uploads
+    if (!transfersOwnership())
+        readyTicket = ticket;
+    return ticket;
+}
+
+void UploadBatch::collect()
+{
+    // Oldest first, stopping at the first batch still running, so tickets become ready in order
+    size_t completed = 0;
+    while (completed < submitted.size() && vkGetFenceStatus(device, submitted[completed].fence) == VK_SUCCESS)
+    {
+        Batch &batch = submitted[completed];
+        vkResetFences(device, 1, &batch.fence);
+        freeFences.push_back(batch.fence);
+
+        acquireBuffers.insert(acquireBuffers.end(), batch.ownershipBuffers.begin(), batch.ownershipBuffers.end());
+        acquireImages.insert(acquireImages.end(), batch.ownershipImages.begin(), batch.ownershipImages.end());
+        acquireMipChains.insert(acquireMipChains.end(), batch.mipChains.begin(), batch.mipChains.end());
+        acquireTicket = batch.ticket;
+
+        release(batch);
+        completed++;
+    }
+    submitted.erase(submitted.begin(), submitted.begin() + completed);
+
+    // Without ownership transfers there is nothing to acquire
+    if (transfersOwnership() && !hasAcquireBarriers())
+        readyTicket = acquireTicket;
+}
+
+void UploadBatch::waitIdle()
+{
+    if (submitted.empty())
+        return;
+
+    CPU_ZONE("uploadBatchWait");
+    std::vector<VkFence> fences;
+    for (const Batch &batch : submitted)
+    {
+        fences.push_back(batch.fence);
+    }
+    vkWaitForFences(device, static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
+    collect();
+}
+
+uint64_t UploadBatch::recordAcquireBarriers(VkCommandBuffer commandBuffer)
+{
+    if (!hasAcquireBarriers())
+        return acquireTicket;
+
+    // The semaphore wait orders these after the release; nothing earlier on this queue is involved
+    BarrierBuilder barriers(pipelineBarrier2);
+    for (VkBufferMemoryBarrier2 barrier : acquireBuffers)
+    {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barriers.buffer(barrier);
+    }
+    for (VkImageMemoryBarrier2 barrier : acquireImages)
+    {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barriers.image(barrier);
+    }
+    barriers.flush(commandBuffer);
+
+    for (const MipChain &chain : acquireMipChains)
+    {
+        recordMipChain(commandBuffer, barriers, chain);
+    }
+    barriers.flush(commandBuffer);
+
+    acquireBuffers.clear();
+    acquireImages.clear();
+    acquireMipChains.clear();
+    readyTicket = acquireTicket;
+    return acquireTicket;
+}
+
+void UploadBatch::recordMipChain(VkCommandBuffer commandBuffer, BarrierBuilder &barriers, const MipChain &chain)
+{
+    int32_t mipWidth = static_cast<int32_t>(chain.width);
+    int32_t mipHeight = static_cast<int32_t>(chain.height);
+
+    // Each level is read by the blit into the next once its own write has finished
+    for (uint32_t level = 1; level < chain.mipLevels; level++)
+    {
+        barriers.transition(chain.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                            BarrierBuilder::subresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 1));
+        barriers.flush(commandBuffer);
+
+        int32_t nextWidth = std::max(mipWidth / 2, 1);
+        int32_t nextHeight = std::max(mipHeight / 2, 1);
+
+        VkImageBlit blit{};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+        vkCmdBlitImage(commandBuffer, chain.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, chain.image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        mipWidth = nextWidth;
+        mipHeight = nextHeight;
+    }
+
+    // Every level but the last was a blit source
+    barriers.transition(chain.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        BarrierBuilder::subresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, chain.mipLevels - 1));
+    barriers.transition(chain.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        BarrierBuilder::subresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, chain.mipLevels - 1, 1));
+}
+
+void UploadBatch::release(Batch &batch)
+{
+    if (batch.commandBuffer != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(device, commandPool, 1, &batch.commandBuffer);
+        batch.commandBuffer = VK_NULL_HANDLE;
+    }
+    for (StagingChunk &chunk : batch.chunks)
+    {
+        vkDestroyBuffer(device, chunk.buffer, nullptr);
+        allocator->free(chunk.allocation);
+    }
+    batch.chunks.clear();
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "barrier_builder.h"
+#include "memory_allocator.h"
+
+#include <cstdint>
+#include <vector>
+
+// A range of staging memory holding data copied in by UploadBatch::stage()
+struct StagedData
+{
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;
+};
+
+// Gathers buffer copies, image copies and layout transitions into one command buffer.
+//
+// Data is staged into large host-visible chunks instead of a buffer per upload, and
+// nothing is submitted until submit(). The submission carries a fence; collect() frees
+// its command buffer and staging chunks once the fence has signalled, so the CPU never
+// waits for an upload unless it asks to with waitIdle(). All calls are no-ops until
+// init() succeeds. Consecutive layout transitions are recorded as one barrier, right
+// before the next command that depends on them.
+//
+// On the queue that uses the resources, submit() ends the batch with a barrier making
+// every transfer write visible to later reads on that queue. On a dedicated transfer
+// queue the batch instead releases ownership of every destination to ownerQueueFamily
+// and signals a timeline semaphore, so uploads stream while the owner queue keeps
+// rendering. Once a batch has completed, recordAcquireBarriers() takes ownership back
+// on the owner queue; that submission must wait on getTimelineSemaphore() at the
+// returned value, which has already been signalled and so never stalls.
+class UploadBatch
+{
+public:
+  static constexpr VkDeviceSize STAGING_CHUNK_SIZE = 4 * 1024 * 1024;
+
+  // ownerQueueFamily is the family that uses the uploaded resources. A different family than
+  // queueFamily needs the timelineSemaphore device feature. pipelineBarrier2 is the device's
+  // vkCmdPipelineBarrier2, or null to record barriers with vkCmdPipelineBarrier.
+  void init(VkDevice device, MemoryAllocator &allocator, VkQueue queue, uint32_t queueFamily,
+            uint32_t ownerQueueFamily, PFN_vkCmdPipelineBarrier2 pipelineBarrier2);
+  // Waits for every submission, then frees everything
+  void destroy();
+
+  // Copies data into staging memory that stays valid until the batch has been submitted and completed
+  StagedData stage(const void *data, VkDeviceSize size);
+  // Stages data and records its copy into dstBuffer
+  void uploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+  // As above, but writes straight into dstAllocation when it is mapped (device-local memory on
+  // unified-memory devices), skipping the staging copy. The GPU must not be using dstBuffer.
+  void uploadBuffer(VkBuffer dstBuffer, const MemoryAllocation &dstAllocation, const void *data, VkDeviceSize size,
+                    VkDeviceSize dstOffset = 0);
+  // Stages tightly packed pixels and records the transition to TRANSFER_DST_OPTIMAL, the copy
+  // into mip 0, and the transition to SHADER_READ_ONLY_OPTIMAL. With mipLevels > 1 the other
+  // levels are generated from mip 0 by a chain of linear blits, which needs TRANSFER_SRC usage,
+  // a format that supports linear blits and a graphics-capable owner queue. When transferring
+  // ownership the blits are recorded by recordAcquireBarriers() instead.
+  void uploadImage(VkImage image, uint32_t width, uint32_t height, const void *data, VkDeviceSize size,
+                   uint32_t mipLevels = 1);
+
+  // When transferring ownership, srcBuffer must not be owned by another queue family; staged data never is
+  void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0,
+                  VkDeviceSize dstOffset = 0);
+  void copyBufferToImage(VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image, uint32_t width, uint32_t height);
+  // Supports UNDEFINED as the old layout and TRANSFER_DST_OPTIMAL, SHADER_READ_ONLY_OPTIMAL,
+  // DEPTH_STENCIL_ATTACHMENT_OPTIMAL and GENERAL on either side. When transferring ownership,
+  // transitions out of TRANSFER_DST_OPTIMAL happen as part of the release and acquire.
+  void transitionImageLayout(VkImage image, VkImageAspectFlags aspectMask, VkImageLayout oldLayout,
+                             VkImageLayout newLayout);
+  void transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                             const VkImageSubresourceRange &range);
+  // The batch's command buffer, begun on first use, for transfer commands without a helper.
+  // Pending transitions are recorded first.
+  VkCommandBuffer getCommandBuffer();
+
+  bool hasRecordedCommands() const { return current.commandBuffer != VK_NULL_HANDLE; }
+  bool hasPendingSubmissions() const { return !submitted.empty(); }
+  // Submits everything recorded so far and returns its ticket; with nothing recorded, returns
+  // the ticket of the last submission
+  uint64_t submit();
+  // Frees the resources of every submission that has completed, without blocking
+  void collect();
+  // Blocks until every submission has completed, then collects them
+  void waitIdle();
+  // Whether resources uploaded by ticket's submission may be used on the owner queue by
+  // commands recorded from now on
+  bool isReady(uint64_t ticket) const { return ticket <= readyTicket; }
+
+  bool transfersOwnership() const { return ownerQueueFamily != queueFamily; }
+  VkSemaphore getTimelineSemaphore() const { return timelineSemaphore; }
+  bool hasAcquireBarriers() const { return !acquireBuffers.empty() || !acquireImages.empty(); }
+  // Records the owner queue's half of the ownership transfers of every completed submission,
+  // followed by their mip generation, and returns the timeline value its submission must wait on
+  uint64_t recordAcquireBarriers(VkCommandBuffer commandBuffer);
+
+  uint32_t getSubmitCount() const { return submitCount; }
+  VkDeviceSize getBytesStaged() const { return bytesStaged; }
+  // Bytes uploadBuffer wrote straight into mapped destinations instead of staging
+  VkDeviceSize getBytesWrittenDirectly() const { return bytesWrittenDirectly; }
+
+private:
+  struct StagingChunk
+  {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    MemoryAllocation allocation;
+    VkDeviceSize size = 0;
+    VkDeviceSize head = 0;
+  };
+
+  // An image whose mip 0 has been written and whose other levels are still to be blitted.
+  // Every level is in TRANSFER_DST_OPTIMAL.
+  struct MipChain
+  {
+    VkImage image = VK_NULL_HANDLE;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipLevels = 1;
+  };
+
+  // One command buffer and the staging chunks it reads from
+  struct Batch
+  {
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    uint64_t ticket = 0;
+    std::vector<StagingChunk> chunks;
+    // Destinations whose ownership moves to ownerQueueFamily, with the owner's stage and access masks
+    std::vector<VkBufferMemoryBarrier2> ownershipBuffers;
+    std::vector<VkImageMemoryBarrier2> ownershipImages;
+    // Mip generation for the owner queue to run after acquiring ownershipImages
+    std::vector<MipChain> mipChains;
+  };
+
+  // Begins the batch's command buffer if needed, without recording pending transitions
+  VkCommandBuffer beginCommandBuffer();
+  // Records the blits of chain into commandBuffer, leaving the transitions of every level to
+  // SHADER_READ_ONLY_OPTIMAL in barriers
+  static void recordMipChain(VkCommandBuffer commandBuffer, BarrierBuilder &barriers, const MipChain &chain);
+  void release(Batch &batch);
+
+  VkDevice device = VK_NULL_HANDLE;
+  MemoryAllocator *allocator = nullptr;
+  VkQueue queue = VK_NULL_HANDLE;
+  uint32_t queueFamily = 0;
+  uint32_t ownerQueueFamily = 0;
+  PFN_vkCmdPipelineBarrier2 pipelineBarrier2 = nullptr;
+  VkCommandPool commandPool = VK_NULL_HANDLE;
+
+  Batch current;
+  // Transitions recorded into current at the next command or at submit()
+  BarrierBuilder pendingBarriers;
+  std::vector<Batch> submitted;
+  // Fences of collected batches, reset and ready for reuse
+  std::vector<VkFence> freeFences;
+
+  // Signalled with a submission's ticket when it completes; only used when transferring ownership
+  VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+  // Ownership transfers of completed batches, waiting for recordAcquireBarriers()
+  std::vector<VkBufferMemoryBarrier2> acquireBuffers;
+  std::vector<VkImageMemoryBarrier2> acquireImages;
+  std::vector<MipChain> acquireMipChains;
+  uint64_t acquireTicket = 0;
+
+  uint64_t readyTicket = 0;
+  uint32_t submitCount = 0;
+  VkDeviceSize bytesStaged = 0;
+  VkDeviceSize bytesWrittenDirectly = 0;
+};
@@ -0,0 +1,74 @@
+#include "upload_ring.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void UploadRing::init(VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator &allocator, uint32_t frameCount,
+                      const std::vector<uint32_t> &queueFamilies, VkDeviceSize frameSize)
+{
+    this->device = device;
+    this->allocator = &allocator;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    alignment = std::max(properties.limits.minUniformBufferOffsetAlignment,
+                         properties.limits.minStorageBufferOffsetAlignment);
+
+    // Keep every slice aligned so offsets stay valid dynamic offsets
+    this->frameSize = (frameSize + alignment - 1) / alignment * alignment;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = this->frameSize * frameCount;
+    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (queueFamilies.size() > 1)
+    {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+        bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+    }
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create upload ring buffer!");
+    }
+
+    allocation = allocator.allocateForBuffer(buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+
+    frameStart = 0;
+    head = 0;
+}
+
+void UploadRing::destroy()
+{
+    if (buffer == VK_NULL_HANDLE)
+        return;
+
+    vkDestroyBuffer(device, buffer, nullptr);
+    allocator->free(allocation);
+    buffer = VK_NULL_HANDLE;
+}
+
+void UploadRing::beginFrame(uint32_t frameIndex)
+{
+    frameStart = frameSize * frameIndex;
+    head = frameStart;
+}
+
+UploadAllocation UploadRing::allocate(VkDeviceSize size)
+{
+    if (head + size > frameStart + frameSize)
+    {
+        throw std::runtime_error("Upload ring frame slice exhausted!");
+    }
+
+    UploadAllocation result;
+    result.mapped = static_cast<char *>(allocation.mapped) + head;
+    result.buffer = buffer;
+    result.offset = static_cast<uint32_t>(head);
+
+    head = std::min(frameStart + frameSize, (head + size + alignment - 1) / alignment * alignment);
+    return result;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "memory_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// A sub-range of the upload ring, valid until the same frame slot comes around again
+struct UploadAllocation
+{
+  void *mapped = nullptr;
+  VkBuffer buffer = VK_NULL_HANDLE;
+  // Offset from the start of buffer; pass as the dynamic offset when bound as a dynamic descriptor
+  uint32_t offset = 0;
+};
+
+// Persistently mapped linear allocator for per-frame uniform and storage data.
+//
+// The buffer is split into one slice per frame in flight. beginFrame() rewinds a
+// slice once its fence has signalled, so the CPU never writes memory the GPU may
+// still be reading and no map/unmap happens per frame. Allocations are aligned
+// for use with UNIFORM_BUFFER_DYNAMIC and STORAGE_BUFFER_DYNAMIC descriptors.
+class UploadRing
+{
+public:
+  static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 256 * 1024;
+
+  // The buffer is shared concurrently when more than one queue family reads from it
+  void init(VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator &allocator, uint32_t frameCount,
+            const std::vector<uint32_t> &queueFamilies = {}, VkDeviceSize frameSize = DEFAULT_FRAME_SIZE);
+  void destroy();
+
+  // Rewinds the slice for frameIndex. Call only after that frame's fence has been waited on.
+  void beginFrame(uint32_t frameIndex);
+
+  UploadAllocation allocate(VkDeviceSize size);
+
+  // Copies value into the ring and returns its offset
+  template <typename T>
+  uint32_t push(const T &value)
+  {
+    UploadAllocation allocation = allocate(sizeof(T));
+    std::memcpy(allocation.mapped, &value, sizeof(T));
+    return allocation.offset;
+  }
+
+  VkBuffer getBuffer() const { return buffer; }
+
+private:
+  VkDevice device = VK_NULL_HANDLE;
+  MemoryAllocator *allocator = nullptr;
+  VkBuffer buffer = VK_NULL_HANDLE;
+  MemoryAllocation allocation;
+  VkDeviceSize frameSize = 0;
+  VkDeviceSize alignment = 1;
+  VkDeviceSize frameStart = 0;
+  VkDeviceSize head = 0;
+};
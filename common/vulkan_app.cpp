@@ -1,4 +1,6 @@
 #include "vulkan_app.h"
+#include "embedded_shaders.h"
+#include "startup_report.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -9,7 +11,13 @@
 #include <fstream>
 #include <filesystem>
 #include <chrono>
-#include <thread>
+#include <cctype>
+#include <cstdlib>
+#include <mutex>
+
+#ifdef RENDERDOCLAB_HAS_SHADERC
+#include <shaderc/shaderc.hpp>
+#endif
 
 // Constants
 const std::vector<const char *> validationLayers = {
@@ -41,7 +49,8 @@ std::vector<char> VulkanApp::readFile(const std::string &filename)
             file.open(path, std::ios::ate | std::ios::binary);
             if (file.is_open())
             {
-                std::cout << "Successfully opened shader file at: " << path << std::endl;
+                if (std::this_thread::get_id() == mainThreadId)
+                    std::cout << "Successfully opened shader file at: " << path << std::endl;
                 break;
             }
         }
@@ -64,14 +73,86 @@ std::vector<char> VulkanApp::readFile(const std::string &filename)
     return buffer;
 }
 
+// Identifies the compiler and its settings in shader cache keys
+#ifdef RENDERDOCLAB_HAS_SHADERC
+static const std::string SHADER_COMPILER_ID = "shaderc -g -O0";
+#else
+static const std::string SHADER_COMPILER_ID = "glslc -g -O0";
+#endif
+
 // Helper function to compile shader from GLSL to SPIR-V at runtime
 std::vector<char> VulkanApp::compileShader(const std::string &filename, VkShaderStageFlagBits shaderStage)
 {
+    CPU_ZONE("compileShader");
+
+    // Shaders precompiled at build time need neither the compiler nor any file I/O
+    if (const EmbeddedShader *embedded = findEmbeddedShader(std::filesystem::path(filename).filename().string()))
+    {
+        const char *bytes = reinterpret_cast<const char *>(embedded->code);
+        return std::vector<char>(bytes, bytes + embedded->size);
+    }
+
     // First, read the shader source
     std::vector<char> shaderSource = this->readFile(filename);
 
+    // Unchanged sources are served from the on-disk SPIR-V cache
+    uint64_t cacheKey = ShaderCache::computeKey(shaderSource, static_cast<uint32_t>(shaderStage), SHADER_COMPILER_ID);
+    if (auto cached = shaderCache.load(cacheKey))
+    {
+        return std::move(*cached);
+    }
+
+    std::vector<char> compiledShader = compileShaderSource(shaderSource, filename, shaderStage);
+    shaderCache.store(cacheKey, compiledShader);
+    return compiledShader;
+}
+
+std::vector<char> VulkanApp::compileShaderSource(const std::vector<char> &shaderSource, const std::string &filename,
+                                                 VkShaderStageFlagBits shaderStage)
+{
+#ifdef RENDERDOCLAB_HAS_SHADERC
+    // Compile in-process with shaderc. The source never touches the disk and
+    // no glslc process has to be spawned.
+    shaderc_shader_kind shaderKind;
+    switch (shaderStage)
+    {
+    case VK_SHADER_STAGE_VERTEX_BIT:
+        shaderKind = shaderc_glsl_vertex_shader;
+        break;
+    case VK_SHADER_STAGE_FRAGMENT_BIT:
+        shaderKind = shaderc_glsl_fragment_shader;
+        break;
+    case VK_SHADER_STAGE_COMPUTE_BIT:
+        shaderKind = shaderc_glsl_compute_shader;
+        break;
+    default:
+        throw std::runtime_error("Unsupported shader stage");
+    }
+
+    // The compiler is safe to share between threads and expensive to create
+    static const shaderc::Compiler compiler;
+
+    // Same settings as glslc -g -O0 so RenderDoc can show and step the GLSL source
+    shaderc::CompileOptions options;
+    options.SetGenerateDebugInfo();
+    options.SetOptimizationLevel(shaderc_optimization_level_zero);
+
+    shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(
+        shaderSource.data(), shaderSource.size(), shaderKind, filename.c_str(), "main", options);
+
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+    {
+        throw std::runtime_error("Failed to compile shader: " + filename + "\n" + result.GetErrorMessage());
+    }
+
+    return std::vector<char>(reinterpret_cast<const char *>(result.cbegin()),
+                             reinterpret_cast<const char *>(result.cend()));
+#else
     // Create a temporary file for the compiled shader
 #pragma warning(disable : 4996) // Disable warning about using tmpnam
+    // tmpnam is not thread-safe and shaders are compiled on several jobs at once
+    static std::mutex tmpnamMutex;
+    std::unique_lock<std::mutex> tmpnamLock(tmpnamMutex);
     std::string tempFilename = std::tmpnam(nullptr);
     tempFilename += ".spv";
 
@@ -97,6 +178,7 @@ std::vector<char> VulkanApp::compileShader(const std::string &filename, VkShader
     std::ofstream sourceFile(sourceFilename);
     sourceFile.write(shaderSource.data(), shaderSource.size());
     sourceFile.close();
+    tmpnamLock.unlock();
 
     // Compile the shader using glslc with debug information
     std::string command = "glslc -g -O0 " + shaderTypeFlag + " " + sourceFilename + " -o " + tempFilename;
@@ -115,6 +197,7 @@ std::vector<char> VulkanApp::compileShader(const std::string &filename, VkShader
     std::remove(tempFilename.c_str());
 
     return compiledShader;
+#endif
 }
 
 // Debug messenger setup and cleanup functions
@@ -145,13 +228,150 @@ VulkanApp::~VulkanApp()
     cleanup();
 }
 
+void VulkanApp::init()
+{
+    // The report is built from CPU zones, so record them for init even without --cpu-profile
+    std::string startupReport = getStartupReportDestination();
+    if (!startupReport.empty())
+    {
+        CpuProfiler::setEnabled(true);
+    }
+
+    jobSystem.init(jobWorkerCount);
+
+    {
+        CPU_ZONE("init");
+        initWindow();
+        initVulkan();
+        // Everything staged while initializing reaches the GPU in a single submission
+        uploadBatch.submit();
+        // A transfer queue's uploads are only acquired by a frame once they have completed,
+        // and the first frame already draws with them
+        if (uploadBatch.transfersOwnership())
+        {
+            uploadBatch.waitIdle();
+        }
+    }
+
+    if (!startupReport.empty())
+    {
+        writeStartupReport(startupReport, appName, CpuProfiler::getThreadEvents(),
+                           CpuProfiler::getOtherThreadEvents());
+        CpuProfiler::setEnabled(!cpuProfilePath.empty());
+    }
+
+    // Animation starts with the first frame, not while pipelines are still being built
+    startTime = std::chrono::steady_clock::now();
+}
+
 void VulkanApp::run()
 {
     mainLoop();
+    writeProfiles();
+}
+
+bool VulkanApp::parseCount(const std::string &arg, const char *value, uint32_t &count)
+{
+    try
+    {
+        size_t used = 0;
+        unsigned long parsed = std::stoul(value, &used);
+        if (std::isdigit(static_cast<unsigned char>(value[0])) && value[used] == '\0' &&
+            parsed <= std::numeric_limits<uint32_t>::max())
+        {
+            count = static_cast<uint32_t>(parsed);
+            return true;
+        }
+    }
+    catch (const std::exception &)
+    {
+    }
+    std::cerr << "Ignoring invalid value for " << arg << ": " << value << std::endl;
+    return false;
+}
+
+void VulkanApp::parseArgs(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--headless")
+        {
+            uint32_t frames = headlessFrameCount;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+            {
+                parseCount(arg, argv[++i], frames);
+            }
+            setHeadless(true, frames);
+        }
+        else if (arg == "--gpu-profile" && i + 1 < argc)
+        {
+            gpuProfilePath = argv[++i];
+        }
+        else if (arg == "--frames-in-flight" && i + 1 < argc)
+        {
+            uint32_t count = 0;
+            if (parseCount(arg, argv[++i], count))
+            {
+                setFramesInFlight(count);
+            }
+        }
+        else if (arg == "--record-threads" && i + 1 < argc)
+        {
+            uint32_t count = 0;
+            if (parseCount(arg, argv[++i], count))
+            {
+                setRecordThreadCount(count);
+            }
+        }
+        else if (arg == "--job-threads" && i + 1 < argc)
+        {
+            uint32_t count = 0;
+            if (parseCount(arg, argv[++i], count))
+            {
+                setJobWorkerCount(count);
+            }
+        }
+        else if (arg == "--no-transfer-queue")
+        {
+            setTransferQueueEnabled(false);
+        }
+        else if (arg == "--benchmark" && i + 1 < argc)
+        {
+            if (parseCount(arg, argv[++i], benchmarkFrameCount))
+            {
+                targetFPS = 0.0f;
+            }
+        }
+        else if (arg == "--stats-json" && i + 1 < argc)
+        {
+            statsPath = argv[++i];
+        }
+        else if (arg == "--cpu-profile" && i + 1 < argc)
+        {
+            cpuProfilePath = argv[++i];
+            CpuProfiler::setThreadName("main");
+            CpuProfiler::setEnabled(true);
+        }
+        else
+        {
+            std::cerr << "Ignoring unknown argument: " << arg << std::endl;
+        }
+    }
+
+    // A benchmark decides the frame count, with or without a window
+    if (benchmarkFrameCount > 0)
+    {
+        headlessFrameCount = benchmarkFrameCount;
+    }
 }
 
 void VulkanApp::initWindow()
 {
+    // Headless runs have no window; nothing to create
+    if (headless)
+        return;
+
     glfwInit();
 
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
@@ -183,55 +403,121 @@ void VulkanApp::keyCallback(GLFWwindow *window, int key, int scancode, int actio
 
 void VulkanApp::initVulkan()
 {
-    createInstance();
-    setupDebugMessenger();
-    createSurface();
-    pickPhysicalDevice();
-    createLogicalDevice();
-    createSwapChain();
-    createImageViews();
-    createRenderPass();
-    createGraphicsPipeline();
-    createFramebuffers();
-    createCommandPool();
-    createCommandBuffers();
-    createSyncObjects();
+    CPU_ZONE_CALL("beginShaderPreload", beginShaderPreload());
+    CPU_ZONE_CALL("createInstance", createInstance());
+    CPU_ZONE_CALL("setupDebugMessenger", setupDebugMessenger());
+    CPU_ZONE_CALL("createSurface", createSurface());
+    CPU_ZONE_CALL("pickPhysicalDevice", pickPhysicalDevice());
+    CPU_ZONE_CALL("createLogicalDevice", createLogicalDevice());
+    CPU_ZONE_CALL("createMemoryAllocator", createMemoryAllocator());
+    CPU_ZONE_CALL("createUploadRing", createUploadRing());
+    CPU_ZONE_CALL("createUploadBatch", createUploadBatch());
+    CPU_ZONE_CALL("createPipelineCache", createPipelineCache());
+    CPU_ZONE_CALL("createSwapChain", createSwapChain());
+    CPU_ZONE_CALL("createImageViews", createImageViews());
+    CPU_ZONE_CALL("createRenderPass", createRenderPass());
+    CPU_ZONE_CALL("finishShaderPreload", finishShaderPreload());
+    CPU_ZONE_CALL("createGraphicsPipeline", createGraphicsPipeline());
+    CPU_ZONE_CALL("createFramebuffers", createFramebuffers());
+    CPU_ZONE_CALL("createCommandPool", createCommandPool());
+    CPU_ZONE_CALL("createGpuProfiler", createGpuProfiler());
+    CPU_ZONE_CALL("createCommandBuffers", createCommandBuffers());
+    CPU_ZONE_CALL("createFrameContexts", createFrameContexts());
+    CPU_ZONE_CALL("createParallelRecorder", createParallelRecorder());
 }
 
 void VulkanApp::mainLoop()
 {
-    while (!glfwWindowShouldClose(window))
+    if (headless)
     {
-        auto frameStart = std::chrono::steady_clock::now();
-        glfwPollEvents();
+        // Render a fixed number of frames as fast as possible and report throughput
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < headlessFrameCount; i++)
+        {
+            drawFrame();
+        }
+        vkDeviceWaitIdle(device);
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double seconds = elapsed.count();
+        std::cout << "Headless: rendered " << headlessFrameCount << " frames in "
+                  << seconds * 1000.0 << " ms ("
+                  << (seconds > 0.0 ? headlessFrameCount / seconds : 0.0) << " fps)" << std::endl;
+        return;
+    }
+
+    while (!glfwWindowShouldClose(window) && (benchmarkFrameCount == 0 || frameNumber < benchmarkFrameCount))
+    {
+        {
+            CPU_ZONE("pollEvents");
+            glfwPollEvents();
+        }
         drawFrame();
 
-        if (targetFPS > 0.0f)
         {
-            auto frameEnd = std::chrono::steady_clock::now();
-            std::chrono::duration<float> elapsed = frameEnd - frameStart;
-            float targetSeconds = 1.0f / targetFPS;
-            if (elapsed.count() < targetSeconds)
-            {
-                std::this_thread::sleep_for(
-                    std::chrono::duration<float>(targetSeconds - elapsed.count()));
-            }
+            CPU_ZONE("frameLimiter");
+            framePacer.waitForNextFrame(targetFPS);
         }
     }
 
     vkDeviceWaitIdle(device);
+
+    if (targetFPS > 0.0f)
+    {
+        framePacer.printSummary(std::cout);
+    }
 }
 
 void VulkanApp::cleanup()
 {
+    // Jobs may still use the device or shader cache if init threw part-way
+    jobSystem.shutdown();
+
     cleanupSwapChain();
 
-    std::ranges::for_each(renderFinishedSemaphores, [d = device](VkSemaphore s)
-                          { vkDestroySemaphore(d, s, nullptr); });
-    std::ranges::for_each(imageAvailableSemaphores, [d = device](VkSemaphore s)
-                          { vkDestroySemaphore(d, s, nullptr); });
-    std::ranges::for_each(inFlightFences, [d = device](VkFence f)
-                          { vkDestroyFence(d, f, nullptr); });
+    // The pipeline, its layout and the render pass outlive swapchain recreation
+    if (graphicsPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    }
+
+    if (_pipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(device, _pipelineLayout, nullptr);
+    }
+
+    if (renderPass != VK_NULL_HANDLE)
+    {
+        vkDestroyRenderPass(device, renderPass, nullptr);
+    }
+
+    destroyShaderModules();
+    destroyPipelineCache();
+
+    uploadRing.destroy();
+    if (uploadBatch.getSubmitCount() > 0 || uploadBatch.getBytesWrittenDirectly() > 0)
+    {
+        std::cout << "Uploads: " << uploadBatch.getSubmitCount() << " submissions, "
+                  << uploadBatch.getBytesStaged() / 1024 << " KiB staged on the "
+                  << (uploadBatch.transfersOwnership() ? "transfer" : "graphics") << " queue, "
+                  << uploadBatch.getBytesWrittenDirectly() / 1024 << " KiB written directly" << std::endl;
+    }
+    uploadBatch.destroy();
+    gpuProfiler.destroy();
+    parallelRecorder.destroy();
+
+    MemoryStats memoryStats = allocator.getStats();
+    if (memoryStats.blockCount + memoryStats.dedicatedCount > 0)
+    {
+        std::cout << "Device memory: " << memoryStats.allocationCount << " allocations in "
+                  << memoryStats.blockCount << " blocks + " << memoryStats.dedicatedCount << " dedicated, "
+                  << memoryStats.bytesUsed / 1024 << " / " << memoryStats.bytesReserved / 1024 << " KiB used, "
+                  << memoryStats.freeRangeCount << " free ranges, fragmentation "
+                  << memoryStats.fragmentation << std::endl;
+    }
+    allocator.destroy();
+
+    destroyFrameContexts();
 
     if (commandPool != VK_NULL_HANDLE)
     {
@@ -244,18 +530,35 @@ void VulkanApp::cleanup()
         DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
     }
 
+    if (shaderCache.getHits() + shaderCache.getMisses() > 0)
+    {
+        std::cout << "Shader cache (" << shaderCache.getDirectory().string() << "): "
+                  << shaderCache.getHits() << " hits, " << shaderCache.getMisses() << " misses" << std::endl;
+    }
+    if (jobSystem.getWorkerCount() > 0)
+    {
+        jobSystem.printUtilization(std::cout);
+    }
+
     vkDestroySurfaceKHR(instance, surface, nullptr);
     vkDestroyInstance(instance, nullptr);
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (window)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 }
 
 void VulkanApp::createInstance()
 {
-    if (enableValidationLayers && !checkValidationLayerSupport())
+    if (enableValidationLayers)
     {
-        throw std::runtime_error("Validation layers requested, but not available!");
+        CPU_ZONE("checkValidationLayerSupport");
+        if (!checkValidationLayerSupport())
+        {
+            throw std::runtime_error("Validation layers requested, but not available!");
+        }
     }
 
     VkApplicationInfo appInfo{};
@@ -264,7 +567,19 @@ void VulkanApp::createInstance()
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    // 1.1 for vkGet*MemoryRequirements2, used to honor dedicated allocation preferences,
+    // 1.2 for the timeline semaphores that order transfer queue uploads before rendering,
+    // and 1.3 for vkCmdPipelineBarrier2. Older devices fall back where needed. A 1.0 loader
+    // has no vkEnumerateInstanceVersion and rejects any newer version.
+    instanceApiVersion = VK_API_VERSION_1_0;
+    auto enumerateInstanceVersion =
+        (PFN_vkEnumerateInstanceVersion)vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion");
+    if (enumerateInstanceVersion)
+    {
+        enumerateInstanceVersion(&instanceApiVersion);
+        instanceApiVersion = std::min(instanceApiVersion, static_cast<uint32_t>(VK_API_VERSION_1_3));
+    }
+    appInfo.apiVersion = instanceApiVersion;
 
     VkInstanceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -289,6 +604,8 @@ void VulkanApp::createInstance()
         createInfo.pNext = nullptr;
     }
 
+    // Loads the ICDs and, in debug builds, the validation layer
+    CPU_ZONE("vkCreateInstance");
     if (vkCreateInstance(&createInfo, nullptr, &instance) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create Vulkan instance!");
@@ -311,6 +628,9 @@ void VulkanApp::setupDebugMessenger()
 
 void VulkanApp::createSurface()
 {
+    if (headless)
+        return;
+
     if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create window surface!");
@@ -330,13 +650,50 @@ void VulkanApp::pickPhysicalDevice()
     std::vector<VkPhysicalDevice> devices(deviceCount);
     vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
 
+    // RENDERDOCLAB_DEVICE_TYPE=cpu|discrete|integrated|virtual prefers a device of that type,
+    // e.g. a software rasterizer such as lavapipe for reproducible benchmarks
+    std::optional<VkPhysicalDeviceType> preferredType;
+    if (const char *type = std::getenv("RENDERDOCLAB_DEVICE_TYPE"))
+    {
+        std::string name = type;
+        if (name == "cpu")
+            preferredType = VK_PHYSICAL_DEVICE_TYPE_CPU;
+        else if (name == "discrete")
+            preferredType = VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+        else if (name == "integrated")
+            preferredType = VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU;
+        else if (name == "virtual")
+            preferredType = VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU;
+        else
+            std::cerr << "Ignoring unknown RENDERDOCLAB_DEVICE_TYPE: " << name << std::endl;
+    }
+
     for (const auto &d : devices)
     {
-        if (isDeviceSuitable(d))
+        if (!isDeviceSuitable(d))
+            continue;
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(d, &properties);
+        if (!preferredType || properties.deviceType == *preferredType)
         {
             physicalDevice = d;
             break;
         }
+        if (physicalDevice == VK_NULL_HANDLE)
+        {
+            physicalDevice = d;
+        }
+    }
+
+    if (preferredType && physicalDevice != VK_NULL_HANDLE)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        if (properties.deviceType != *preferredType)
+        {
+            std::cerr << "No device of the requested RENDERDOCLAB_DEVICE_TYPE, using " << properties.deviceName << std::endl;
+        }
     }
 
     if (physicalDevice == VK_NULL_HANDLE)
@@ -346,11 +703,19 @@ void VulkanApp::pickPhysicalDevice()
 }
 
 void VulkanApp::createLogicalDevice()
+{
+    createDevice({}, findUploadTransferFamily());
+}
+
+void VulkanApp::createDevice(const std::set<uint32_t> &extraQueueFamilies, std::optional<uint32_t> transferFamily)
 {
     QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+    uniqueQueueFamilies.insert(extraQueueFamilies.begin(), extraQueueFamilies.end());
+    if (transferFamily)
+        uniqueQueueFamilies.insert(transferFamily.value());
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -366,13 +731,48 @@ void VulkanApp::createLogicalDevice()
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE; // Enable anisotropic filtering feature
 
+    Synchronization2Support synchronization2 = getSynchronization2Support();
+    void *featureChain = nullptr;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    if (transferFamily)
+    {
+        vulkan12Features.pNext = featureChain;
+        featureChain = &vulkan12Features;
+    }
+
+    VkPhysicalDeviceVulkan13Features vulkan13Features{};
+    vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    vulkan13Features.synchronization2 = VK_TRUE;
+    if (synchronization2 == Synchronization2Support::Core)
+    {
+        vulkan13Features.pNext = featureChain;
+        featureChain = &vulkan13Features;
+    }
+
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+    synchronization2Features.synchronization2 = VK_TRUE;
+    if (synchronization2 == Synchronization2Support::Extension)
+    {
+        synchronization2Features.pNext = featureChain;
+        featureChain = &synchronization2Features;
+    }
+
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = featureChain;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+
+    auto extensions = getDeviceExtensions();
+    if (synchronization2 == Synchronization2Support::Extension)
+        extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
     if (enableValidationLayers)
     {
@@ -391,10 +791,234 @@ void VulkanApp::createLogicalDevice()
 
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+    if (transferFamily)
+    {
+        transferQueueFamily = transferFamily.value();
+        vkGetDeviceQueue(device, transferQueueFamily, 0, &transferQueue);
+    }
+    cmdPipelineBarrier2 = BarrierBuilder::loadPipelineBarrier2(device, synchronization2);
+}
+
+uint32_t VulkanApp::getDeviceApiVersion()
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    return std::min(properties.apiVersion, instanceApiVersion);
+}
+
+Synchronization2Support VulkanApp::getSynchronization2Support()
+{
+    // Feature queries need 1.1
+    uint32_t apiVersion = getDeviceApiVersion();
+    if (apiVersion < VK_API_VERSION_1_1)
+        return Synchronization2Support::None;
+
+    if (apiVersion >= VK_API_VERSION_1_3)
+    {
+        VkPhysicalDeviceVulkan13Features vulkan13Features{};
+        vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &vulkan13Features;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+        if (vulkan13Features.synchronization2)
+            return Synchronization2Support::Core;
+    }
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+    bool hasExtension = false;
+    for (const auto &extension : availableExtensions)
+    {
+        if (std::strcmp(extension.extensionName, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) == 0)
+            hasExtension = true;
+    }
+    if (!hasExtension)
+        return Synchronization2Support::None;
+
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &synchronization2Features;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+    return synchronization2Features.synchronization2 ? Synchronization2Support::Extension
+                                                     : Synchronization2Support::None;
+}
+
+std::optional<uint32_t> VulkanApp::findUploadTransferFamily()
+{
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    if (!transferQueueEnabled || !indices.transferFamily)
+        return std::nullopt;
+
+    if (getDeviceApiVersion() < VK_API_VERSION_1_2)
+        return std::nullopt;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+    if (!vulkan12Features.timelineSemaphore)
+        return std::nullopt;
+
+    return indices.transferFamily;
+}
+
+void VulkanApp::createMemoryAllocator()
+{
+    // Dedicated allocation queries need a 1.1 device
+    allocator.init(physicalDevice, device, getDeviceApiVersion() >= VK_API_VERSION_1_1);
+}
+
+void VulkanApp::createUploadRing(std::optional<uint32_t> asyncComputeFamily)
+{
+    // Only shared concurrently when an async compute queue reads the uniform data too
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    std::set<uint32_t> families = {indices.graphicsFamily.value()};
+    if (asyncComputeFamily)
+    {
+        families.insert(asyncComputeFamily.value());
+    }
+    uploadRing.init(physicalDevice, device, allocator, framesInFlight,
+                    std::vector<uint32_t>(families.begin(), families.end()));
+}
+
+void VulkanApp::createUploadBatch()
+{
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    uint32_t graphicsFamily = indices.graphicsFamily.value();
+    if (transferQueue != VK_NULL_HANDLE)
+    {
+        uploadBatch.init(device, allocator, transferQueue, transferQueueFamily, graphicsFamily, cmdPipelineBarrier2);
+    }
+    else
+    {
+        uploadBatch.init(device, allocator, graphicsQueue, graphicsFamily, graphicsFamily, cmdPipelineBarrier2);
+    }
+}
+
+void VulkanApp::createParallelRecorder()
+{
+    if (recordThreadCount == 0)
+        return;
+
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    parallelRecorder.init(device, indices.graphicsFamily.value(), recordThreadCount, framesInFlight);
+}
+
+void VulkanApp::createGpuProfiler()
+{
+    // Frame stats report GPU time, so they need the timestamps too
+    if (gpuProfilePath.empty() && statsPath.empty())
+        return;
+
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    uint32_t graphicsFamily = indices.graphicsFamily.value();
+    gpuProfiler.init(physicalDevice, device, framesInFlight, graphicsFamily,
+                     indices.computeFamily.value_or(graphicsFamily));
+    gpuProfiler.calibrate(graphicsQueue, commandPool);
+}
+
+void VulkanApp::writeProfiles()
+{
+    // The device is idle once the main loop returns, so every frame's queries are complete
+    gpuProfiler.collectAll();
+
+    writeGpuProfile();
+    writeCpuProfile();
+    writeFrameStats();
+    printBenchmarkResults();
+}
+
+void VulkanApp::writeGpuProfile()
+{
+    if (!gpuProfiler.isEnabled() || gpuProfilePath.empty())
+        return;
+
+    gpuProfiler.printSummary();
+
+    std::filesystem::path tracePath = gpuProfilePath;
+    tracePath += ".json";
+    std::filesystem::path csvPath = gpuProfilePath;
+    csvPath += ".csv";
+    gpuProfiler.writeChromeTrace(tracePath);
+    gpuProfiler.writeCsv(csvPath);
+    std::cout << "GPU profile written to " << tracePath.string() << " and " << csvPath.string() << std::endl;
+}
+
+void VulkanApp::writeFrameStats()
+{
+    if (statsPath.empty())
+        return;
+
+    frameStats.addGpuZones(gpuProfiler.getResults());
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    frameStats.writeJson(statsPath, appName, properties.deviceName);
+    std::cout << "Frame stats for " << frameStats.getFrameCount() << " frames written to " << statsPath.string()
+              << std::endl;
+}
+
+void VulkanApp::recordFrameStats(double submitStartUs)
+{
+    frameNumber++;
+    if (statsPath.empty() && benchmarkFrameCount == 0)
+        return;
+
+    // The first frame has no predecessor to measure an interval from
+    double nowUs = profilerClockMicros();
+    if (lastSubmitUs > 0.0)
+    {
+        frameStats.addFrame((nowUs - lastSubmitUs) / 1000.0, (nowUs - submitStartUs) / 1000.0);
+    }
+    lastSubmitUs = nowUs;
+}
+
+void VulkanApp::printBenchmarkResults()
+{
+    if (benchmarkFrameCount == 0)
+        return;
+
+    FrameTimeSummary summary = frameStats.getFrameTimeSummary();
+    std::cout << "Benchmark: " << frameNumber << " frames, frame time min " << summary.min << " ms, avg "
+              << summary.mean << " ms, p99 " << summary.p99 << " ms ("
+              << (summary.mean > 0.0 ? 1000.0 / summary.mean : 0.0) << " fps)" << std::endl;
+}
+
+double VulkanApp::getAnimationTime() const
+{
+    if (benchmarkFrameCount > 0)
+    {
+        return static_cast<double>(frameNumber) * BENCHMARK_TIME_STEP;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void VulkanApp::writeCpuProfile()
+{
+    if (cpuProfilePath.empty())
+        return;
+
+    CpuProfiler::printSummary();
+    // Both profilers share the steady_clock time base, so GPU zones can go in the same file
+    CpuProfiler::writeChromeTrace(cpuProfilePath, &gpuProfiler);
+    std::cout << "CPU profile written to " << cpuProfilePath.string() << std::endl;
 }
 
 void VulkanApp::createSwapChain()
 {
+    if (headless)
+    {
+        createOffscreenImages();
+        return;
+    }
+
     SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
 
     VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -452,6 +1076,24 @@ void VulkanApp::createSwapChain()
     swapChainExtent = extent;
 }
 
+void VulkanApp::createOffscreenImages()
+{
+    CPU_ZONE("createOffscreenImages");
+    // One color target per frame in flight; drawFrame uses currentFrame as the image index
+    swapChainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+    swapChainExtent = {static_cast<uint32_t>(windowWidth), static_cast<uint32_t>(windowHeight)};
+
+    swapChainImages.resize(framesInFlight);
+    offscreenImageAllocations.resize(framesInFlight);
+
+    for (size_t i = 0; i < framesInFlight; i++)
+    {
+        createImage(swapChainExtent.width, swapChainExtent.height, swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, swapChainImages[i], offscreenImageAllocations[i]);
+    }
+}
+
 void VulkanApp::createImageViews()
 {
     swapChainImageViews.resize(swapChainImages.size());
@@ -490,7 +1132,8 @@ void VulkanApp::createRenderPass()
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // Offscreen targets are left ready for readback instead of presentation
+    colorAttachment.finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -526,39 +1169,9 @@ void VulkanApp::createRenderPass()
 
 void VulkanApp::createGraphicsPipeline()
 {
-    std::vector<char> vertShaderCode;
-    std::vector<char> fragShaderCode;
-
-    try
-    {
-        // Try to compile shaders at runtime
-        std::cout << "Attempting to compile shaders at runtime..." << std::endl;
-        vertShaderCode = compileShader("shader.vert", VK_SHADER_STAGE_VERTEX_BIT);
-        fragShaderCode = compileShader("shader.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
-        std::cout << "Successfully compiled shaders!" << std::endl;
-    }
-    catch (const std::exception &e)
-    {
-        // If runtime compilation fails, try to read the shader files directly
-        std::cout << "Runtime shader compilation failed: " << e.what() << std::endl;
-        std::cout << "Trying to read shader files directly..." << std::endl;
-
-        try
-        {
-            vertShaderCode = readFile("shader.vert");
-            fragShaderCode = readFile("shader.frag");
-            std::cout << "Successfully read shader files!" << std::endl;
-        }
-        catch (const std::exception &e)
-        {
-            std::cerr << "Failed to read shader files: " << e.what() << std::endl;
-            throw; // Re-throw the exception if we can't read the files either
-        }
-    }
-
-    // Create shader modules
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+    // Shader modules are cached, so rebuilding the pipeline never recompiles
+    VkShaderModule vertShaderModule = loadShaderModule("shader.vert", VK_SHADER_STAGE_VERTEX_BIT);
+    VkShaderModule fragShaderModule = loadShaderModule("shader.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
 
     // Shader stage creation
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
@@ -589,25 +1202,18 @@ void VulkanApp::createGraphicsPipeline()
     inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-    // Viewport and scissor
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)swapChainExtent.width;
-    viewport.height = (float)swapChainExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = swapChainExtent;
-
+    // Viewport and scissor are dynamic (set in drawFrame) so the pipeline
+    // doesn't depend on the swapchain extent and survives resizes
     VkPipelineViewportStateCreateInfo viewportState{};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
     viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
+
+    std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
 
     // Rasterizer
     VkPipelineRasterizationStateCreateInfo rasterizer{};
@@ -680,37 +1286,295 @@ void VulkanApp::createGraphicsPipeline()
     pipelineInfo.pMultisampleState = &multisampling;
     pipelineInfo.pDepthStencilState = nullptr;
     pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = nullptr;
+    pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = _pipelineLayout;
     pipelineInfo.renderPass = renderPass;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.basePipelineIndex = -1;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
-    {
-        throw std::runtime_error("Failed to create graphics pipeline!");
+    if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create graphics pipeline!");
+    }
+}
+
+VkShaderModule VulkanApp::createShaderModule(const std::vector<char> &code)
+{
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create shader module!");
+    }
+
+    return shaderModule;
+}
+
+VkShaderModule VulkanApp::loadShaderModule(const std::string &filename, VkShaderStageFlagBits shaderStage)
+{
+    // Modules stay resident until cleanup so pipelines can be rebuilt without recompiling
+    auto it = shaderModules.find(filename);
+    if (it != shaderModules.end())
+    {
+        return it->second;
+    }
+
+    // The preload already failed to compile it; report that once rather than compiling again
+    std::vector<char> code;
+    auto failed = shaderPreloadErrors.find(filename);
+    if (failed != shaderPreloadErrors.end())
+    {
+        code = loadPrecompiledShader(filename, failed->second);
+        shaderPreloadErrors.erase(failed);
+    }
+    else
+    {
+        code = loadShaderCode(filename, shaderStage);
+    }
+
+    VkShaderModule shaderModule = createShaderModule(code);
+    shaderModules[filename] = shaderModule;
+    return shaderModule;
+}
+
+std::vector<char> VulkanApp::loadShaderCode(const std::string &filename, VkShaderStageFlagBits shaderStage)
+{
+    try
+    {
+        return compileShader(filename, shaderStage);
+    }
+    catch (const std::exception &e)
+    {
+        return loadPrecompiledShader(filename, e.what());
+    }
+}
+
+std::vector<char> VulkanApp::loadPrecompiledShader(const std::string &filename, const std::string &compileError)
+{
+    // If runtime compilation fails, fall back to precompiled SPIR-V next to the source
+    std::cout << "Runtime shader compilation failed: " << compileError << std::endl;
+    std::cout << "Trying to read " << filename << ".spv instead..." << std::endl;
+    return readFile(filename + ".spv");
+}
+
+void VulkanApp::beginShaderPreload()
+{
+    std::filesystem::path directory = getShaderDir();
+    std::error_code ec;
+    if (!std::filesystem::is_directory(directory, ec))
+    {
+        directory = "./shaders";
+        if (!std::filesystem::is_directory(directory, ec))
+            return;
+    }
+
+    preloadedShaders.clear();
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory, ec))
+    {
+        std::string extension = entry.path().extension().string();
+        VkShaderStageFlagBits shaderStage;
+        if (extension == ".vert")
+            shaderStage = VK_SHADER_STAGE_VERTEX_BIT;
+        else if (extension == ".frag")
+            shaderStage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        else if (extension == ".comp")
+            shaderStage = VK_SHADER_STAGE_COMPUTE_BIT;
+        else
+            continue;
+        preloadedShaders.push_back({entry.path().filename().string(), entry.path(), shaderStage, {}, {}});
+    }
+    if (preloadedShaders.empty())
+        return;
+
+    auto compile = [this](uint32_t i)
+    {
+        PreloadedShader &shader = preloadedShaders[i];
+        try
+        {
+            shader.code = compileShader(shader.path.string(), shader.shaderStage);
+        }
+        catch (const std::exception &e)
+        {
+            // Kept quiet here: the app may never use this shader, and several workers would
+            // print at once. loadShaderModule reports it if the shader is needed.
+            shader.error = e.what();
+        }
+    };
+    uint32_t shaderCount = static_cast<uint32_t>(preloadedShaders.size());
+
+    // One job forks a compile per shader, so the main thread goes on creating the device meanwhile
+    shaderPreloadJob = jobSystem.schedule([this, compile, shaderCount]
+                                          { jobSystem.parallelFor(shaderCount, compile); });
+}
+
+void VulkanApp::finishShaderPreload()
+{
+    if (!shaderPreloadJob)
+        return;
+
+    jobSystem.wait(shaderPreloadJob);
+    shaderPreloadJob.reset();
+
+    for (PreloadedShader &shader : preloadedShaders)
+    {
+        if (shaderModules.find(shader.filename) != shaderModules.end())
+            continue;
+        if (!shader.code.empty())
+        {
+            shaderModules[shader.filename] = createShaderModule(shader.code);
+        }
+        else
+        {
+            shaderPreloadErrors[shader.filename] = shader.error;
+        }
+    }
+    preloadedShaders.clear();
+}
+
+void VulkanApp::destroyShaderModules()
+{
+    for (auto &[name, shaderModule] : shaderModules)
+    {
+        vkDestroyShaderModule(device, shaderModule, nullptr);
+    }
+    shaderModules.clear();
+}
+
+// Prefix written in front of the driver's cache blob. The driver validates its own
+// header too, but checking here lets us discard stale files from a driver update
+// before handing them to vkCreatePipelineCache.
+struct PipelineCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t driverVersion;
+    uint64_t dataSize;
+};
+static const uint32_t PIPELINE_CACHE_FILE_MAGIC = 0x43504452; // "RDPC"
+
+std::filesystem::path VulkanApp::getPipelineCachePath() const
+{
+    // One file per example, stored alongside the SPIR-V cache
+    std::string name;
+    for (char c : appName)
+    {
+        name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    return shaderCache.getDirectory() / (name + ".pipelinecache");
+}
+
+void VulkanApp::createPipelineCache()
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    std::vector<char> initialData;
+    std::filesystem::path path = getPipelineCachePath();
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (file.is_open())
+    {
+        size_t fileSize = (size_t)file.tellg();
+        std::vector<char> contents(fileSize);
+        file.seekg(0);
+        file.read(contents.data(), fileSize);
+
+        PipelineCacheFileHeader fileHeader{};
+        VkPipelineCacheHeaderVersionOne cacheHeader{};
+        bool valid = file && fileSize >= sizeof(fileHeader) + sizeof(cacheHeader);
+        if (valid)
+        {
+            std::memcpy(&fileHeader, contents.data(), sizeof(fileHeader));
+            std::memcpy(&cacheHeader, contents.data() + sizeof(fileHeader), sizeof(cacheHeader));
+            valid = fileHeader.magic == PIPELINE_CACHE_FILE_MAGIC &&
+                    fileHeader.driverVersion == properties.driverVersion &&
+                    fileHeader.dataSize == fileSize - sizeof(fileHeader) &&
+                    cacheHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                    cacheHeader.vendorID == properties.vendorID &&
+                    cacheHeader.deviceID == properties.deviceID &&
+                    std::memcmp(cacheHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+
+        if (valid)
+        {
+            initialData.assign(contents.begin() + sizeof(fileHeader), contents.end());
+            std::cout << "Pipeline cache: loaded " << initialData.size() << " bytes from " << path.string() << std::endl;
+        }
+        else
+        {
+            std::cout << "Pipeline cache: ignoring " << path.string() << " (different device or driver)" << std::endl;
+        }
     }
 
-    // Cleanup shader modules
-    vkDestroyShaderModule(device, fragShaderModule, nullptr);
-    vkDestroyShaderModule(device, vertShaderModule, nullptr);
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = initialData.size();
+    createInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    if (vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
 }
 
-VkShaderModule VulkanApp::createShaderModule(const std::vector<char> &code)
+void VulkanApp::savePipelineCache()
 {
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+    if (pipelineCache == VK_NULL_HANDLE)
+        return;
 
-    VkShaderModule shaderModule;
-    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        return;
+
+    std::vector<char> data(sizeof(PipelineCacheFileHeader) + dataSize);
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data() + sizeof(PipelineCacheFileHeader)) != VK_SUCCESS)
+        return;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    PipelineCacheFileHeader fileHeader{};
+    fileHeader.magic = PIPELINE_CACHE_FILE_MAGIC;
+    fileHeader.driverVersion = properties.driverVersion;
+    fileHeader.dataSize = dataSize;
+    std::memcpy(data.data(), &fileHeader, sizeof(fileHeader));
+    data.resize(sizeof(fileHeader) + dataSize);
+
+    // Write to a temporary file and rename so a crash never leaves a torn cache behind
+    std::filesystem::path path = getPipelineCachePath();
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
     {
-        throw std::runtime_error("Failed to create shader module!");
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), data.size());
+        if (!file)
+        {
+            std::cerr << "Pipeline cache: failed to write " << tempPath.string() << std::endl;
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        std::cerr << "Pipeline cache: failed to store " << path.string() << ": " << ec.message() << std::endl;
+        std::filesystem::remove(tempPath, ec);
     }
+}
 
-    return shaderModule;
+void VulkanApp::destroyPipelineCache()
+{
+    if (pipelineCache == VK_NULL_HANDLE)
+        return;
+
+    savePipelineCache();
+    vkDestroyPipelineCache(device, pipelineCache, nullptr);
+    pipelineCache = VK_NULL_HANDLE;
 }
 
 void VulkanApp::createFramebuffers()
@@ -755,6 +1619,10 @@ void VulkanApp::createCommandPool()
 
 void VulkanApp::createCommandBuffers()
 {
+    imagesInFlight.assign(swapChainFramebuffers.size(), VK_NULL_HANDLE);
+    if (!staticCommandBuffers)
+        return;
+
     commandBuffers.resize(swapChainFramebuffers.size());
 
     VkCommandBufferAllocateInfo allocInfo{};
@@ -767,13 +1635,18 @@ void VulkanApp::createCommandBuffers()
     {
         throw std::runtime_error("Failed to allocate command buffers!");
     }
+    invalidateCommandBuffers();
 }
 
-void VulkanApp::createSyncObjects()
+void VulkanApp::createFrameContexts()
 {
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+    QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+    frameContexts.resize(framesInFlight);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -782,52 +1655,89 @@ void VulkanApp::createSyncObjects()
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (FrameContext &frame : frameContexts)
     {
-        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &frame.commandPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create frame command pool!");
+        }
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = frame.commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &frame.commandBuffer) != VK_SUCCESS ||
+            vkAllocateCommandBuffers(device, &allocInfo, &frame.acquireCommandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to allocate frame command buffer!");
+        }
+
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &frame.imageAvailable) != VK_SUCCESS ||
+            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &frame.renderFinished) != VK_SUCCESS ||
+            vkCreateFence(device, &fenceInfo, nullptr, &frame.inFlight) != VK_SUCCESS)
         {
             throw std::runtime_error("Failed to create synchronization objects for a frame!");
         }
     }
 }
 
+void VulkanApp::destroyFrameContexts()
+{
+    for (FrameContext &frame : frameContexts)
+    {
+        // Destroying the pool frees its command buffer
+        if (frame.commandPool != VK_NULL_HANDLE)
+            vkDestroyCommandPool(device, frame.commandPool, nullptr);
+        if (frame.imageAvailable != VK_NULL_HANDLE)
+            vkDestroySemaphore(device, frame.imageAvailable, nullptr);
+        if (frame.renderFinished != VK_NULL_HANDLE)
+            vkDestroySemaphore(device, frame.renderFinished, nullptr);
+        if (frame.inFlight != VK_NULL_HANDLE)
+            vkDestroyFence(device, frame.inFlight, nullptr);
+    }
+    frameContexts.clear();
+}
+
 void VulkanApp::recordRenderCommands(VkCommandBuffer commandBuffer)
 {
     // Default implementation draws a single triangle
     vkCmdDraw(commandBuffer, 3, 1, 0, 0);
 }
 
-void VulkanApp::drawFrame()
+void VulkanApp::recordDrawState(VkCommandBuffer commandBuffer)
 {
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
-
-    if (result == VK_ERROR_OUT_OF_DATE_KHR)
-    {
-        recreateSwapChain();
-        return;
-    }
-    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
-    {
-        throw std::runtime_error("Failed to acquire swap chain image!");
-    }
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
 
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float)swapChainExtent.width;
+    viewport.height = (float)swapChainExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-    vkResetCommandBuffer(commandBuffers[imageIndex], 0);
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = swapChainExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
 
+void VulkanApp::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
-    if (vkBeginCommandBuffer(commandBuffers[imageIndex], &beginInfo) != VK_SUCCESS)
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to begin recording command buffer!");
     }
 
+    gpuProfiler.recordReset(commandBuffer);
+    recordPreRenderPassCommands(commandBuffer);
+
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassInfo.renderPass = renderPass;
@@ -839,36 +1749,198 @@ void VulkanApp::drawFrame()
     renderPassInfo.clearValueCount = 1;
     renderPassInfo.pClearValues = &clearColor;
 
-    vkCmdBeginRenderPass(commandBuffers[imageIndex], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(commandBuffers[imageIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    uint32_t renderPassZone = gpuProfiler.beginZone(commandBuffer, "RenderPass");
+    if (usesParallelRecording())
+    {
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+        VkCommandBufferInheritanceInfo inheritance{};
+        inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance.renderPass = renderPass;
+        inheritance.subpass = 0;
+        inheritance.framebuffer = swapChainFramebuffers[imageIndex];
 
-    recordRenderCommands(commandBuffers[imageIndex]);
+        const std::vector<VkCommandBuffer> &secondaries = parallelRecorder.record(
+            static_cast<uint32_t>(currentFrame), inheritance, getParallelDrawCount(),
+            [this](VkCommandBuffer secondary, uint32_t first, uint32_t count)
+            {
+                // Secondary command buffers inherit no state from the primary
+                recordDrawState(secondary);
+                recordParallelRenderCommands(secondary, first, count);
+            });
+        if (!secondaries.empty())
+        {
+            vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+        }
+    }
+    else
+    {
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        recordDrawState(commandBuffer);
+        uint32_t parallelDrawCount = getParallelDrawCount();
+        if (parallelDrawCount > 0)
+        {
+            // No recording threads: the same draws go straight into the primary command buffer
+            recordParallelRenderCommands(commandBuffer, 0, parallelDrawCount);
+        }
+        else
+        {
+            recordRenderCommands(commandBuffer);
+        }
+    }
 
-    vkCmdEndRenderPass(commandBuffers[imageIndex]);
+    vkCmdEndRenderPass(commandBuffer);
+    gpuProfiler.endZone(commandBuffer, renderPassZone);
 
-    if (vkEndCommandBuffer(commandBuffers[imageIndex]) != VK_SUCCESS)
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to record command buffer!");
     }
+}
+
+void VulkanApp::drawFrame()
+{
+    CPU_ZONE("drawFrame");
+    FrameContext &frame = frameContexts[currentFrame];
+
+    {
+        CPU_ZONE("waitForFence");
+        vkWaitForFences(device, 1, &frame.inFlight, VK_TRUE, UINT64_MAX);
+    }
+
+    // The GPU is done with this frame slot, so its command pool, upload slice and timestamps can be reused
+    vkResetCommandPool(device, frame.commandPool, 0);
+    uploadRing.beginFrame(static_cast<uint32_t>(currentFrame));
+    gpuProfiler.beginFrame(static_cast<uint32_t>(currentFrame));
+    uploadBatch.collect();
+
+    // Headless frames render straight into the offscreen image owned by this frame slot
+    uint32_t imageIndex = static_cast<uint32_t>(currentFrame);
+    VkResult result = VK_SUCCESS;
+    if (!headless)
+    {
+        CPU_ZONE("acquireImage");
+        result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, frame.imageAvailable, VK_NULL_HANDLE, &imageIndex);
+    }
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    {
+        recreateSwapChain();
+        return;
+    }
+    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+    {
+        throw std::runtime_error("Failed to acquire swap chain image!");
+    }
+
+    // Images can be acquired out of order, so the last frame that rendered to this image (and
+    // may have submitted its static command buffer) can belong to another, still pending, slot
+    if (imagesInFlight[imageIndex] != VK_NULL_HANDLE && imagesInFlight[imageIndex] != frame.inFlight)
+    {
+        CPU_ZONE("waitForImage");
+        vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+    }
+    imagesInFlight[imageIndex] = frame.inFlight;
+
+    vkResetFences(device, 1, &frame.inFlight);
+
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<VkPipelineStageFlags> waitStages;
+    if (!headless)
+    {
+        waitSemaphores.push_back(frame.imageAvailable);
+        waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    }
+    double submitStartUs = profilerClockMicros();
+    // Uploads staged since the last frame run ahead of it on the graphics queue, or alongside
+    // it on the transfer queue, to be acquired by a later frame once complete
+    uploadBatch.submit();
+    {
+        CPU_ZONE("submitFrameDependencies");
+        submitFrameDependencies(waitSemaphores, waitStages);
+    }
+
+    std::vector<VkCommandBuffer> submitCommandBuffers;
+    // Per wait semaphore; binary semaphores ignore their value
+    std::vector<uint64_t> waitValues(waitSemaphores.size(), 0);
+    if (uploadBatch.hasAcquireBarriers())
+    {
+        CPU_ZONE("recordUploadAcquire");
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (vkBeginCommandBuffer(frame.acquireCommandBuffer, &beginInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to begin recording upload acquire command buffer!");
+        }
+        uint64_t uploadValue = uploadBatch.recordAcquireBarriers(frame.acquireCommandBuffer);
+        if (vkEndCommandBuffer(frame.acquireCommandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to record upload acquire command buffer!");
+        }
+
+        // Already signalled, since the uploads' fence has; the wait only orders release before acquire
+        waitSemaphores.push_back(uploadBatch.getTimelineSemaphore());
+        waitStages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        waitValues.push_back(uploadValue);
+        submitCommandBuffers.push_back(frame.acquireCommandBuffer);
+    }
+
+    VkCommandBuffer commandBuffer = frame.commandBuffer;
+    // Static recordings would keep pointing at secondary buffers that are re-recorded per frame slot
+    if (staticCommandBuffers && !gpuProfiler.isEnabled() && !usesParallelRecording())
+    {
+        commandBuffer = commandBuffers[imageIndex];
+        if (!commandBuffersRecorded[imageIndex])
+        {
+            CPU_ZONE("recordCommands");
+            vkResetCommandBuffer(commandBuffer, 0);
+            recordCommandBuffer(commandBuffer, imageIndex);
+            commandBuffersRecorded[imageIndex] = true;
+        }
+    }
+    else
+    {
+        CPU_ZONE("recordCommands");
+        recordCommandBuffer(commandBuffer, imageIndex);
+    }
+    submitCommandBuffers.push_back(commandBuffer);
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+    timelineInfo.pWaitSemaphoreValues = waitValues.data();
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    // Timeline semaphores only exist when uploads stream on a transfer queue
+    submitInfo.pNext = uploadBatch.transfersOwnership() ? &timelineInfo : nullptr;
 
-    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffers[imageIndex];
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.commandBufferCount = static_cast<uint32_t>(submitCommandBuffers.size());
+    submitInfo.pCommandBuffers = submitCommandBuffers.data();
 
-    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    VkSemaphore signalSemaphores[] = {frame.renderFinished};
+    submitInfo.signalSemaphoreCount = headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
     {
-        throw std::runtime_error("Failed to submit draw command buffer!");
+        CPU_ZONE("submit");
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, frame.inFlight) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to submit draw command buffer!");
+        }
+    }
+    recordFrameStats(submitStartUs);
+
+    if (headless)
+    {
+        // Nothing to present; the in-flight fence alone paces the offscreen ring
+        currentFrame = (currentFrame + 1) % framesInFlight;
+        return;
     }
 
     VkPresentInfoKHR presentInfo{};
@@ -882,7 +1954,10 @@ void VulkanApp::drawFrame()
     presentInfo.pImageIndices = &imageIndex;
     presentInfo.pResults = nullptr;
 
-    result = vkQueuePresentKHR(presentQueue, &presentInfo);
+    {
+        CPU_ZONE("present");
+        result = vkQueuePresentKHR(presentQueue, &presentInfo);
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
     {
@@ -894,11 +1969,12 @@ void VulkanApp::drawFrame()
         throw std::runtime_error("Failed to present swap chain image!");
     }
 
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    currentFrame = (currentFrame + 1) % framesInFlight;
 }
 
 void VulkanApp::recreateSwapChain()
 {
+    CPU_ZONE("recreateSwapChain");
     int w = 0, h = 0;
     glfwGetFramebufferSize(window, &w, &h);
     while (w == 0 || h == 0)
@@ -909,14 +1985,30 @@ void VulkanApp::recreateSwapChain()
 
     vkDeviceWaitIdle(device);
 
+    VkFormat oldFormat = swapChainImageFormat;
+
     cleanupSwapChain();
 
-    createSwapChain();
-    createImageViews();
-    createRenderPass();
-    createGraphicsPipeline();
-    createFramebuffers();
-    createCommandBuffers();
+    CPU_ZONE_CALL("createSwapChain", createSwapChain());
+    CPU_ZONE_CALL("createImageViews", createImageViews());
+
+    // The render pass (and the pipeline built against it) only depends on the
+    // image format; the extent is dynamic state. Keep both unless the format changed.
+    if (swapChainImageFormat != oldFormat)
+    {
+        vkDestroyPipeline(device, graphicsPipeline, nullptr);
+        vkDestroyPipelineLayout(device, _pipelineLayout, nullptr);
+        vkDestroyRenderPass(device, renderPass, nullptr);
+        graphicsPipeline = VK_NULL_HANDLE;
+        _pipelineLayout = VK_NULL_HANDLE;
+        renderPass = VK_NULL_HANDLE;
+
+        CPU_ZONE_CALL("createRenderPass", createRenderPass());
+        CPU_ZONE_CALL("createGraphicsPipeline", createGraphicsPipeline());
+    }
+
+    CPU_ZONE_CALL("createFramebuffers", createFramebuffers());
+    CPU_ZONE_CALL("createCommandBuffers", createCommandBuffers());
 }
 
 void VulkanApp::cleanupSwapChain()
@@ -926,29 +2018,25 @@ void VulkanApp::cleanupSwapChain()
         vkDestroyFramebuffer(device, framebuffer, nullptr);
     }
 
-    if (commandPool != VK_NULL_HANDLE)
+    if (commandPool != VK_NULL_HANDLE && !commandBuffers.empty())
     {
         vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+        commandBuffers.clear();
     }
 
-    if (graphicsPipeline != VK_NULL_HANDLE)
-    {
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
-    }
-
-    if (_pipelineLayout != VK_NULL_HANDLE)
-    {
-        vkDestroyPipelineLayout(device, _pipelineLayout, nullptr);
-    }
-
-    if (renderPass != VK_NULL_HANDLE)
+    for (auto imageView : swapChainImageViews)
     {
-        vkDestroyRenderPass(device, renderPass, nullptr);
+        vkDestroyImageView(device, imageView, nullptr);
     }
 
-    for (auto imageView : swapChainImageViews)
+    if (headless)
     {
-        vkDestroyImageView(device, imageView, nullptr);
+        for (size_t i = 0; i < swapChainImages.size(); i++)
+        {
+            destroyImage(swapChainImages[i], offscreenImageAllocations[i]);
+        }
+        swapChainImages.clear();
+        offscreenImageAllocations.clear();
     }
 
     if (swapChain != VK_NULL_HANDLE)
@@ -989,11 +2077,16 @@ bool VulkanApp::checkValidationLayerSupport()
 
 std::vector<const char *> VulkanApp::getRequiredExtensions()
 {
-    uint32_t glfwExtensionCount = 0;
-    const char **glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char *> extensions;
 
-    std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    // Surface extensions are only needed when presenting to a window
+    if (!headless)
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char **glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (enableValidationLayers)
     {
@@ -1003,6 +2096,15 @@ std::vector<const char *> VulkanApp::getRequiredExtensions()
     return extensions;
 }
 
+std::vector<const char *> VulkanApp::getDeviceExtensions() const
+{
+    // Headless devices never create a swapchain
+    if (headless)
+        return {};
+
+    return deviceExtensions;
+}
+
 void VulkanApp::populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo)
 {
     createInfo = {};
@@ -1037,8 +2139,8 @@ bool VulkanApp::isDeviceSuitable(VkPhysicalDevice dev)
 
     bool extensionsSupported = checkDeviceExtensionSupport(dev);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported)
+    bool swapChainAdequate = headless;
+    if (extensionsSupported && !headless)
     {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(dev);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -1059,7 +2161,8 @@ bool VulkanApp::checkDeviceExtensionSupport(VkPhysicalDevice dev)
     std::vector<VkExtensionProperties> availableExtensions(extensionCount);
     vkEnumerateDeviceExtensionProperties(dev, nullptr, &extensionCount, availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+    auto extensions = getDeviceExtensions();
+    std::set<std::string> requiredExtensions(extensions.begin(), extensions.end());
 
     for (const auto &extension : availableExtensions)
     {
@@ -1079,35 +2182,60 @@ VulkanApp::QueueFamilyIndices VulkanApp::findQueueFamilies(VkPhysicalDevice dev)
     std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(dev, &queueFamilyCount, queueFamilies.data());
 
+    // Prefer a compute-only family so compute work can run asynchronously to graphics
+    std::optional<uint32_t> anyComputeFamily;
+
     int i = 0;
     for (const auto &queueFamily : queueFamilies)
     {
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !indices.graphicsFamily)
         {
             indices.graphicsFamily = i;
         }
 
+        // Graphics and compute families support transfers too, whether they report it or not
+        if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !indices.transferFamily &&
+            !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+        {
+            indices.transferFamily = i;
+        }
+
         if (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)
         {
-            indices.computeFamily = i;
+            if (!(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !indices.computeFamily)
+            {
+                indices.computeFamily = i;
+            }
+            if (!anyComputeFamily)
+            {
+                anyComputeFamily = i;
+            }
         }
 
+        // Without a surface, the graphics queue stands in for the present queue
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(dev, i, surface, &presentSupport);
-
-        if (presentSupport)
+        if (headless)
         {
-            indices.presentFamily = i;
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        }
+        else
+        {
+            vkGetPhysicalDeviceSurfaceSupportKHR(dev, i, surface, &presentSupport);
         }
 
-        if (indices.graphicsFamily && indices.presentFamily && indices.computeFamily)
+        if (presentSupport && !indices.presentFamily)
         {
-            break;
+            indices.presentFamily = i;
         }
 
         i++;
     }
 
+    if (!indices.computeFamily)
+    {
+        indices.computeFamily = anyComputeFamily;
+    }
+
     return indices;
 }
 
@@ -1186,6 +2314,84 @@ VkExtent2D VulkanApp::chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilit
     }
 }
 
+void VulkanApp::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                             VkBuffer &buffer, MemoryAllocation &allocation)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create buffer!");
+    }
+
+    allocation = allocator.allocateForBuffer(buffer, properties);
+    vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+}
+
+void VulkanApp::destroyBuffer(VkBuffer &buffer, MemoryAllocation &allocation)
+{
+    vkDestroyBuffer(device, buffer, nullptr);
+    allocator.free(allocation);
+    buffer = VK_NULL_HANDLE;
+}
+
+void VulkanApp::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
+                            VkMemoryPropertyFlags properties, VkImage &image, MemoryAllocation &allocation,
+                            uint32_t mipLevels)
+{
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = width;
+    imageInfo.extent.height = height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = format;
+    imageInfo.tiling = tiling;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = usage;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create image!");
+    }
+
+    allocation = allocator.allocateForImage(image, tiling, properties);
+    vkBindImageMemory(device, image, allocation.memory, allocation.offset);
+}
+
+uint32_t VulkanApp::getMipLevelCount(VkFormat format, uint32_t width, uint32_t height)
+{
+    // UploadBatch generates the chain with linear blits from each level into the next
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                    VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    if ((formatProperties.optimalTilingFeatures & required) != required)
+        return 1;
+
+    uint32_t mipLevels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+    {
+        mipLevels++;
+    }
+    return mipLevels;
+}
+
+void VulkanApp::destroyImage(VkImage &image, MemoryAllocation &allocation)
+{
+    vkDestroyImage(device, image, nullptr);
+    allocator.free(allocation);
+    image = VK_NULL_HANDLE;
+}
+
 VkCommandBuffer VulkanApp::beginSingleTimeCommands()
 {
     VkCommandBufferAllocateInfo allocInfo{};
@@ -1215,88 +2421,52 @@ void VulkanApp::endSingleTimeCommands(VkCommandBuffer commandBuffer)
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
+    // Wait for this submission only, not for everything else on the queue
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create fence!");
+    }
+
+    vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence);
+    vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(device, fence, nullptr);
 
     vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
 }
 
-static bool hasStencilComponent(VkFormat format)
+// Every aspect of format, which is what a transition of the whole image has to cover
+static VkImageAspectFlags getAspectMask(VkFormat format)
 {
-    return format == VK_FORMAT_D32_SFLOAT_S8_UINT ||
-           format == VK_FORMAT_D24_UNORM_S8_UINT;
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_S8_UINT:
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
 }
 
 void VulkanApp::transitionImageLayout(VkImage image, VkFormat format,
                                       VkImageLayout oldLayout,
                                       VkImageLayout newLayout)
 {
-    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = image;
-
-    if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-    {
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        if (hasStencilComponent(format))
-        {
-            barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-        }
-    }
-    else
-    {
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    }
-
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-
-    VkPipelineStageFlags sourceStage;
-    VkPipelineStageFlags destinationStage;
-
-    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
-        newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-             newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-    {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
-             newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
-                                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    }
-    else
-    {
-        throw std::runtime_error("Unsupported layout transition!");
-    }
-
-    vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage,
-                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+    uploadBatch.transitionImageLayout(image, getAspectMask(format), oldLayout, newLayout);
+}
 
-    endSingleTimeCommands(commandBuffer);
+void VulkanApp::transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format,
+                                      VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+    BarrierBuilder barriers(cmdPipelineBarrier2);
+    barriers.transition(image, oldLayout, newLayout, BarrierBuilder::subresourceRange(getAspectMask(format)));
+    barriers.flush(commandBuffer);
 }
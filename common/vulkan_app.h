@@ -4,11 +4,28 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
+#include "barrier_builder.h"
+#include "cpu_profiler.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "gpu_profiler.h"
+#include "job_system.h"
+#include "memory_allocator.h"
+#include "parallel_recorder.h"
+#include "shader_cache.h"
+#include "upload_batch.h"
+#include "upload_ring.h"
+
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <optional>
+#include <set>
 #include <array>
+#include <chrono>
 #include <filesystem>
+#include <unordered_map>
+#include <thread>
 
 // Global validation and extension lists shared with helpers
 extern const std::vector<const char *> validationLayers;
@@ -18,7 +35,22 @@ extern const bool enableValidationLayers;
 #define VULKANAPP_GETSHADERDIR \
   ((std::filesystem::path{__FILE__}.parent_path() / "shaders").generic_string() + '/')
 
-#define MAX_FRAMES_IN_FLIGHT 2
+// Upper bound of VulkanApp::framesInFlight; fixed-size per-frame arrays are sized by it
+#define MAX_FRAMES_IN_FLIGHT 3
+
+// Everything one frame in flight owns. A context is reused once its fence has signalled,
+// so its transient command pool is reset as a whole rather than buffer by buffer. The
+// frame's slices of uploadRing and gpuProfiler are keyed by the same index.
+struct FrameContext
+{
+  VkCommandPool commandPool = VK_NULL_HANDLE;
+  VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+  // Acquires ownership of uploads completed on the transfer queue, submitted ahead of commandBuffer
+  VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+  VkSemaphore imageAvailable = VK_NULL_HANDLE;
+  VkSemaphore renderFinished = VK_NULL_HANDLE;
+  VkFence inFlight = VK_NULL_HANDLE;
+};
 
 class VulkanApp
 {
@@ -28,21 +60,78 @@ public:
   {
   }
 
-  void init()
-  {
-    initWindow();
-    initVulkan();
-  }
+  // Creates the window and initializes Vulkan. Set RENDERDOCLAB_STARTUP_REPORT to print how
+  // long each step took (see startup_report.h).
+  void init();
   virtual ~VulkanApp();
 
   void run();
 
+  // Parses common command line options:
+  //   --headless [frames]     render offscreen without a window for a fixed number of frames
+  //   --gpu-profile <prefix>  record GPU timestamp zones and write <prefix>.json and <prefix>.csv
+  //   --cpu-profile <path>    record CPU zones and write a Chrome trace, merged with any GPU zones
+  //   --stats-json <path>     write frame time, CPU submit and GPU time percentiles as JSON
+  //   --benchmark <frames>    render exactly that many frames uncapped with fixed-step animation
+  //                           time, then print frame time statistics
+  //   --frames-in-flight <n>  number of frames the CPU may run ahead of the GPU (1 to MAX_FRAMES_IN_FLIGHT)
+  //   --record-threads <n>    record getParallelDrawCount() draws on n threads (0 for the main thread only)
+  //   --job-threads <n>       worker threads of the job system (0 runs jobs on the waiting thread)
+  //   --no-transfer-queue     submit uploads on the graphics queue even when a transfer-only family exists
+  void parseArgs(int argc, char **argv);
+  // Parses value as a non-negative 32-bit count into count. An invalid value is reported as
+  // ignored for arg and leaves count unchanged.
+  static bool parseCount(const std::string &arg, const char *value, uint32_t &count);
+
+  // Headless mode renders into a ring of offscreen images instead of a swapchain,
+  // so no window, surface or present queue is needed. Must be set before init().
+  void setHeadless(bool enabled, uint32_t frameCount = 300)
+  {
+    headless = enabled;
+    headlessFrameCount = frameCount;
+  }
+  bool isHeadless() const { return headless; }
+
   // Called on key events. Default implementation does nothing
   virtual void onKey(int /*key*/, int /*scancode*/, int /*action*/, int /*mods*/) {}
 
   void setTargetFPS(float fps) { targetFPS = fps; }
   float getTargetFPS() const { return targetFPS; }
 
+  // Frames the CPU may record ahead of the GPU, clamped to [1, MAX_FRAMES_IN_FLIGHT].
+  // Must be set before init().
+  void setFramesInFlight(uint32_t count) { framesInFlight = std::clamp(count, 1u, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)); }
+  uint32_t getFramesInFlight() const { return framesInFlight; }
+
+  // Threads that record the draws of apps overriding recordParallelRenderCommands; 0 records
+  // them on the main thread straight into the primary command buffer. Must be set before init().
+  void setRecordThreadCount(uint32_t count) { recordThreadCount = count; }
+  uint32_t getRecordThreadCount() const { return recordThreadCount; }
+
+  // Workers of jobSystem, next to the main thread that also runs jobs while it waits.
+  // Defaults to one fewer than the hardware thread count. Must be set before init().
+  void setJobWorkerCount(uint32_t count) { jobWorkerCount = count; }
+  uint32_t getJobWorkerCount() const { return jobWorkerCount; }
+
+  // Streams uploadBatch on a transfer-only queue family, when the device has one and supports
+  // timeline semaphores, so uploads overlap rendering. Must be set before init().
+  void setTransferQueueEnabled(bool enabled) { transferQueueEnabled = enabled; }
+  bool isTransferQueueEnabled() const { return transferQueueEnabled; }
+
+  // Records each swapchain image's command buffer once and resubmits it every frame,
+  // for apps whose commands never change. Call invalidateCommandBuffers() after changing
+  // anything the recording depends on; swapchain recreation does so itself. Ignored while
+  // the GPU profiler is enabled, since its zones are written per frame slot. Must be
+  // enabled before init().
+  void setStaticCommandBuffers(bool enabled)
+  {
+    staticCommandBuffers = enabled;
+    invalidateCommandBuffers();
+  }
+  void invalidateCommandBuffers() { commandBuffersRecorded.assign(commandBuffers.size(), false); }
+  // Achieved frame intervals and missed deadlines of the windowed loop
+  const FrameIntervalHistogram &getFrameIntervalHistogram() const { return framePacer.getHistogram(); }
+
 private:
   const std::string shaderDir;
 
@@ -54,14 +143,42 @@ protected:
   GLFWwindow *window = nullptr;
   // Desired frame rate. Defaults to 30 FPS. When 0, rendering runs without delay.
   float targetFPS = 30.0f;
+  // Benchmark runs stop after this many frames; 0 runs until the window closes
+  uint32_t benchmarkFrameCount = 0;
+  // Animation time advanced per frame in benchmark mode, so every run renders identical frames
+  static constexpr double BENCHMARK_TIME_STEP = 1.0 / 60.0;
+  // Frames submitted so far
+  uint64_t frameNumber = 0;
+  std::chrono::steady_clock::time_point startTime;
+  // Headless rendering state. In headless mode swapChainImages holds the offscreen images.
+  bool headless = false;
+  uint32_t headlessFrameCount = 300;
+  std::vector<MemoryAllocation> offscreenImageAllocations;
+  // GPU timestamp zones are only recorded when an output prefix is set
+  std::filesystem::path gpuProfilePath;
+  // CPU zones are recorded process-wide once a trace path is set
+  std::filesystem::path cpuProfilePath;
+  // Per-frame timings are only collected when a stats path is set
+  std::filesystem::path statsPath;
+  FrameStats frameStats;
+  FramePacer framePacer;
+  double lastSubmitUs = 0.0;
 
   // Vulkan objects
   VkInstance instance = VK_NULL_HANDLE;
+  // The instance's API version: the loader's, capped at the 1.3 this app is written against
+  uint32_t instanceApiVersion = VK_API_VERSION_1_0;
   VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
   VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
   VkDevice device = VK_NULL_HANDLE;
+  // The device's vkCmdPipelineBarrier2, null without synchronization2; pass it to every BarrierBuilder
+  PFN_vkCmdPipelineBarrier2 cmdPipelineBarrier2 = nullptr;
   VkQueue graphicsQueue = VK_NULL_HANDLE;
   VkQueue presentQueue = VK_NULL_HANDLE;
+  // Only created when uploads stream on a transfer-only family; see findUploadTransferFamily()
+  VkQueue transferQueue = VK_NULL_HANDLE;
+  uint32_t transferQueueFamily = 0;
+  bool transferQueueEnabled = true;
   VkSurfaceKHR surface = VK_NULL_HANDLE;
   VkSwapchainKHR swapChain = VK_NULL_HANDLE;
   std::vector<VkImage> swapChainImages;
@@ -71,12 +188,38 @@ protected:
   VkRenderPass renderPass = VK_NULL_HANDLE;
   VkPipelineLayout _pipelineLayout = VK_NULL_HANDLE;
   VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+  // Shared by every pipeline creation; persisted to disk between runs
+  VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+  // Sub-allocates device memory for every buffer and image
+  MemoryAllocator allocator;
+  // Per-frame uniform/storage data; the current frame's slice is rewound after its fence wait
+  UploadRing uploadRing;
+  // Staged buffer and image uploads, submitted together at the end of init() and before each frame,
+  // on transferQueue when there is one. Check uploadBatch.isReady() before using resources
+  // uploaded after init().
+  UploadBatch uploadBatch;
+  // Timestamp zones; use GpuZone inside recordRenderCommands and compute recording
+  GpuProfiler gpuProfiler;
+  uint32_t recordThreadCount = 0;
+  // Secondary command buffer recording, created when recordThreadCount > 0
+  ParallelRecorder parallelRecorder;
+  uint32_t jobWorkerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+  // Fork/join and dependent jobs for CPU work such as shader compilation and asset generation
+  JobSystem jobSystem;
   std::vector<VkFramebuffer> swapChainFramebuffers;
   VkCommandPool commandPool = VK_NULL_HANDLE;
+  // Per image, only allocated for static command buffers; frames otherwise record into
+  // their FrameContext
   std::vector<VkCommandBuffer> commandBuffers;
-  std::vector<VkSemaphore> imageAvailableSemaphores;
-  std::vector<VkSemaphore> renderFinishedSemaphores;
-  std::vector<VkFence> inFlightFences;
+  bool staticCommandBuffers = false;
+  // Per image: whether commandBuffers[i] holds a recording that can be resubmitted
+  std::vector<bool> commandBuffersRecorded;
+  // Per image: fence of the last frame that rendered to it, so an image acquired out of
+  // order is never written while an earlier frame still uses it
+  std::vector<VkFence> imagesInFlight;
+  uint32_t framesInFlight = 2;
+  std::vector<FrameContext> frameContexts;
+  // Index into frameContexts and every other per-frame resource
   size_t currentFrame = 0;
   bool framebufferResized = false;
 
@@ -92,40 +235,128 @@ protected:
   void createSurface();
   void pickPhysicalDevice();
   void createLogicalDevice();
+  // Creates the device with one queue each from the graphics, present, extraQueueFamilies and
+  // transferFamily families, fetches graphicsQueue, presentQueue and transferQueue, and enables
+  // synchronization2 when supported. transferFamily must come from findUploadTransferFamily().
+  void createDevice(const std::set<uint32_t> &extraQueueFamilies, std::optional<uint32_t> transferFamily);
+  void createMemoryAllocator();
+  // asyncComputeFamily is the family of a separate compute queue that reads the ring, if any
+  void createUploadRing(std::optional<uint32_t> asyncComputeFamily = std::nullopt);
+  void createUploadBatch();
+  void createGpuProfiler();
+  void createParallelRecorder();
+  // Writes every requested profile and stats file; call once the device is idle
+  void writeProfiles();
+  void writeGpuProfile();
+  void writeCpuProfile();
+  void writeFrameStats();
+  // Call right after a frame's submission; submitStartUs is when its recording began
+  void recordFrameStats(double submitStartUs);
+  void printBenchmarkResults();
+
+  // Seconds to animate by: wall-clock time since startup, or frameNumber fixed steps in
+  // benchmark mode. Use this instead of reading a clock so benchmark runs are reproducible.
+  double getAnimationTime() const;
+  void createPipelineCache();
+  void savePipelineCache();
+  void destroyPipelineCache();
+  std::filesystem::path getPipelineCachePath() const;
   void createSwapChain();
+  void createOffscreenImages();
   void createImageViews();
   void createRenderPass();
   virtual void createGraphicsPipeline();
   void createFramebuffers();
   void createCommandPool();
   virtual void createCommandBuffers();
-  void createSyncObjects();
+  void createFrameContexts();
+  void destroyFrameContexts();
 
+  // Called each frame once the image is acquired, before graphics work is recorded. Work submitted
+  // to other queues adds the semaphores (and stages) the frame's graphics submission must wait on.
+  virtual void submitFrameDependencies(std::vector<VkSemaphore> & /*waitSemaphores*/,
+                                       std::vector<VkPipelineStageFlags> & /*waitStages*/) {}
+  // Called each frame before the render pass begins, e.g. for compute dispatches and their barriers
+  virtual void recordPreRenderPassCommands(VkCommandBuffer /*commandBuffer*/) {}
   // Called each frame between pipeline bind and render pass end
   virtual void recordRenderCommands(VkCommandBuffer commandBuffer);
+  // Draws that recordParallelRenderCommands splits across the recording threads. While it is 0
+  // (the default) recordRenderCommands records the frame instead.
+  virtual uint32_t getParallelDrawCount() const { return 0; }
+  // Records draws [first, first + count) into a command buffer that already has the pipeline,
+  // viewport and scissor set: a secondary per recording thread, or the primary with all draws
+  // when no threads are configured. Runs on several threads at once, so it may only read shared
+  // state, and must not use GpuZone.
+  virtual void recordParallelRenderCommands(VkCommandBuffer /*commandBuffer*/, uint32_t /*first*/, uint32_t /*count*/) {}
+  bool usesParallelRecording() const { return parallelRecorder.isEnabled() && getParallelDrawCount() > 0; }
+  // Pipeline, viewport and scissor shared by the primary and every secondary command buffer
+  void recordDrawState(VkCommandBuffer commandBuffer);
 
   // Helper functions
   bool checkValidationLayerSupport();
   bool checkDeviceExtensionSupport(VkPhysicalDevice device);
   std::vector<const char *> getRequiredExtensions();
+  std::vector<const char *> getDeviceExtensions() const;
   void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
   bool isDeviceSuitable(VkPhysicalDevice device);
   VkShaderModule createShaderModule(const std::vector<char> &code);
+  // Returns a cached module for filename, compiling it on first use (falls back to filename.spv)
+  VkShaderModule loadShaderModule(const std::string &filename, VkShaderStageFlagBits shaderStage);
+  void destroyShaderModules();
+  // Compiles every shader in the shader directory on the job system, so compilation overlaps
+  // device creation. finishShaderPreload waits for it and turns the SPIR-V into modules that
+  // loadShaderModule then returns; shaders that fail are left to loadShaderModule to report.
+  void beginShaderPreload();
+  void finishShaderPreload();
 
   // Shader helper functions
   std::string getShaderDir() const
   {
     return shaderDir;
   }
+  // Also tries the shader directories; reports where it found the file only on mainThreadId
   std::vector<char> readFile(const std::string &filename);
+  // Compiles GLSL to SPIR-V, going through the on-disk shader cache
   std::vector<char> compileShader(const std::string &filename, VkShaderStageFlagBits shaderStage);
+  std::vector<char> compileShaderSource(const std::vector<char> &shaderSource, const std::string &filename,
+                                        VkShaderStageFlagBits shaderStage);
+  // compileShader, falling back to precompiled filename.spv. Reports a failed compile, so call
+  // it from the main thread; jobs use compileShader directly.
+  std::vector<char> loadShaderCode(const std::string &filename, VkShaderStageFlagBits shaderStage);
+  // Reports why filename could not be compiled and reads the precompiled filename.spv instead
+  std::vector<char> loadPrecompiledShader(const std::string &filename, const std::string &compileError);
+
+  // Persistent SPIR-V cache used by compileShader
+  ShaderCache shaderCache;
+  // Shader modules kept resident for the app's lifetime, keyed by file name
+  std::unordered_map<std::string, VkShaderModule> shaderModules;
+  struct PreloadedShader
+  {
+    // Key in shaderModules
+    std::string filename;
+    // Full path, so workers never search for the file
+    std::filesystem::path path;
+    VkShaderStageFlagBits shaderStage;
+    // Empty if compilation failed
+    std::vector<char> code;
+    std::string error;
+  };
+  std::vector<PreloadedShader> preloadedShaders;
+  JobHandle shaderPreloadJob;
+  // The thread the app was created on, which is the only one that prints progress
+  std::thread::id mainThreadId = std::this_thread::get_id();
+  // Compile errors of preloaded shaders, reported by loadShaderModule if the shader is used
+  std::unordered_map<std::string, std::string> shaderPreloadErrors;
 
   // Struct for queue family indices
   struct QueueFamilyIndices
   {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    // A compute-only family when the device has one, otherwise any compute-capable family
     std::optional<uint32_t> computeFamily;
+    // A family with transfer but neither graphics nor compute, usually backed by a DMA engine
+    std::optional<uint32_t> transferFamily;
 
     bool isComplete()
     {
@@ -134,6 +365,14 @@ protected:
   };
 
   QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device);
+  // The transfer-only family uploads stream on, if enabled and the device supports the
+  // timeline semaphores that order them before rendering
+  std::optional<uint32_t> findUploadTransferFamily();
+  // The API version usable with physicalDevice: the lower of the device's and the instance's
+  uint32_t getDeviceApiVersion();
+  // Whether the device can record barriers with vkCmdPipelineBarrier2 (see BarrierBuilder),
+  // preferring 1.3 core over VK_KHR_synchronization2
+  Synchronization2Support getSynchronization2Support();
 
   uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
   {
@@ -164,17 +403,37 @@ protected:
   VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes);
   VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities);
 
-  // Single-use command helpers
+  // Buffer and image helpers backed by the memory allocator
+  void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                    VkBuffer &buffer, MemoryAllocation &allocation);
+  void destroyBuffer(VkBuffer &buffer, MemoryAllocation &allocation);
+  void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
+                   VkMemoryPropertyFlags properties, VkImage &image, MemoryAllocation &allocation,
+                   uint32_t mipLevels = 1);
+  // Levels of a full mip chain down to 1x1, or 1 when format cannot be mipmapped with linear blits
+  uint32_t getMipLevelCount(VkFormat format, uint32_t width, uint32_t height);
+  void destroyImage(VkImage &image, MemoryAllocation &allocation);
+
+  // Single-use command helpers. endSingleTimeCommands blocks until the commands have run, so
+  // prefer uploadBatch for uploads.
   VkCommandBuffer beginSingleTimeCommands();
   void endSingleTimeCommands(VkCommandBuffer commandBuffer);
 
-  // General image layout transition helper
+  // Records a layout transition of every mip level and layer into uploadBatch; it runs with the
+  // batch's next submission, or on the graphics queue once that submission has completed when
+  // uploads use the transfer queue
   void transitionImageLayout(VkImage image, VkFormat format,
                              VkImageLayout oldLayout,
                              VkImageLayout newLayout);
+  // Records the same transition straight into commandBuffer. Use a BarrierBuilder to batch
+  // several barriers or to transition part of an image.
+  void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format,
+                             VkImageLayout oldLayout, VkImageLayout newLayout);
 
   // Drawing functions
   void drawFrame();
+  // Records the frame's primary command buffer: pre-render-pass work, then the render pass
+  void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
   void recreateSwapChain();
   void cleanupSwapChain();
 
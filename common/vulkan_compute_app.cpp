@@ -6,6 +6,10 @@
 
 VulkanComputeApp::~VulkanComputeApp()
 {
+    for (VkSemaphore semaphore : computeFinishedSemaphores)
+    {
+        vkDestroySemaphore(device, semaphore, nullptr);
+    }
     if (computeCommandPool != VK_NULL_HANDLE)
     {
         vkDestroyCommandPool(device, computeCommandPool, nullptr);
@@ -14,74 +18,52 @@ VulkanComputeApp::~VulkanComputeApp()
 
 void VulkanComputeApp::initVulkan()
 {
-    createInstance();
-    setupDebugMessenger();
-    createSurface();
-    pickPhysicalDevice();
-    createLogicalDevice();
-    createSwapChain();
-    createImageViews();
-    createRenderPass();
-    createGraphicsPipeline();
-    createFramebuffers();
-    createCommandPool();
-    createComputeCommandPool();
-    createCommandBuffers();
-    createSyncObjects();
+    CPU_ZONE_CALL("beginShaderPreload", beginShaderPreload());
+    CPU_ZONE_CALL("createInstance", createInstance());
+    CPU_ZONE_CALL("setupDebugMessenger", setupDebugMessenger());
+    CPU_ZONE_CALL("createSurface", createSurface());
+    CPU_ZONE_CALL("pickPhysicalDevice", pickPhysicalDevice());
+    CPU_ZONE_CALL("createLogicalDevice", createLogicalDevice());
+    CPU_ZONE_CALL("createMemoryAllocator", createMemoryAllocator());
+    std::optional<uint32_t> asyncComputeFamily;
+    if (hasAsyncCompute())
+        asyncComputeFamily = computeQueueFamily;
+    CPU_ZONE_CALL("createUploadRing", createUploadRing(asyncComputeFamily));
+    CPU_ZONE_CALL("createUploadBatch", createUploadBatch());
+    CPU_ZONE_CALL("createPipelineCache", createPipelineCache());
+    CPU_ZONE_CALL("createSwapChain", createSwapChain());
+    CPU_ZONE_CALL("createImageViews", createImageViews());
+    CPU_ZONE_CALL("createRenderPass", createRenderPass());
+    CPU_ZONE_CALL("finishShaderPreload", finishShaderPreload());
+    CPU_ZONE_CALL("createGraphicsPipeline", createGraphicsPipeline());
+    CPU_ZONE_CALL("createFramebuffers", createFramebuffers());
+    CPU_ZONE_CALL("createCommandPool", createCommandPool());
+    CPU_ZONE_CALL("createComputeCommandPool", createComputeCommandPool());
+    CPU_ZONE_CALL("createComputeFrameResources", createComputeFrameResources());
+    CPU_ZONE_CALL("createGpuProfiler", createGpuProfiler());
+    CPU_ZONE_CALL("createCommandBuffers", createCommandBuffers());
+    CPU_ZONE_CALL("createFrameContexts", createFrameContexts());
+    CPU_ZONE_CALL("createParallelRecorder", createParallelRecorder());
 }
 
 void VulkanComputeApp::createLogicalDevice()
 {
     QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
 
-    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
-    if (indices.computeFamily)
-        uniqueQueueFamilies.insert(indices.computeFamily.value());
+    // Uploads are only handed over to the graphics family, so with async compute reading them
+    // too they stay on the graphics queue
+    std::optional<uint32_t> transferFamily;
+    if (indices.computeFamily.value_or(indices.graphicsFamily.value()) == indices.graphicsFamily.value())
+        transferFamily = findUploadTransferFamily();
 
-    float queuePriority = 1.0f;
-    for (uint32_t qFamily : uniqueQueueFamilies)
-    {
-        VkDeviceQueueCreateInfo qInfo{};
-        qInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        qInfo.queueFamilyIndex = qFamily;
-        qInfo.queueCount = 1;
-        qInfo.pQueuePriorities = &queuePriority;
-        queueCreateInfos.push_back(qInfo);
-    }
-
-    VkPhysicalDeviceFeatures deviceFeatures{};
-    deviceFeatures.samplerAnisotropy = VK_TRUE;
-
-    VkDeviceCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
-    createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
-
-    if (enableValidationLayers)
-    {
-        createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
-        createInfo.ppEnabledLayerNames = validationLayers.data();
-    }
-    else
-    {
-        createInfo.enabledLayerCount = 0;
-    }
-
-    if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS)
-    {
-        throw std::runtime_error("Failed to create logical device!");
-    }
-
-    vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
-    vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+    std::set<uint32_t> extraQueueFamilies;
     if (indices.computeFamily)
-        vkGetDeviceQueue(device, indices.computeFamily.value(), 0, &computeQueue);
-    else
-        computeQueue = graphicsQueue;
+        extraQueueFamilies.insert(indices.computeFamily.value());
+    createDevice(extraQueueFamilies, transferFamily);
+
+    graphicsQueueFamily = indices.graphicsFamily.value();
+    computeQueueFamily = indices.computeFamily.value_or(graphicsQueueFamily);
+    vkGetDeviceQueue(device, computeQueueFamily, 0, &computeQueue);
 }
 
 void VulkanComputeApp::createComputeCommandPool()
@@ -89,10 +71,11 @@ void VulkanComputeApp::createComputeCommandPool()
     QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
     uint32_t family = indices.computeFamily ? indices.computeFamily.value() : indices.graphicsFamily.value();
 
+    // Per-frame compute command buffers are reset and re-recorded every frame
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.queueFamilyIndex = family;
-    poolInfo.flags = 0;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
     if (vkCreateCommandPool(device, &poolInfo, nullptr, &computeCommandPool) != VK_SUCCESS)
     {
@@ -100,77 +83,100 @@ void VulkanComputeApp::createComputeCommandPool()
     }
 }
 
-VkCommandBuffer VulkanComputeApp::beginSingleTimeCommands()
+void VulkanComputeApp::createComputeFrameResources()
 {
+    computeCommandBuffers.resize(framesInFlight);
+
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     allocInfo.commandPool = computeCommandPool;
-    allocInfo.commandBufferCount = 1;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = static_cast<uint32_t>(computeCommandBuffers.size());
 
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+    if (vkAllocateCommandBuffers(device, &allocInfo, computeCommandBuffers.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate compute command buffers!");
+    }
 
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    computeFinishedSemaphores.resize(framesInFlight);
 
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    return commandBuffer;
+    for (size_t i = 0; i < framesInFlight; i++)
+    {
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &computeFinishedSemaphores[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create compute semaphores!");
+        }
+    }
 }
 
-void VulkanComputeApp::endSingleTimeCommands(VkCommandBuffer commandBuffer)
+void VulkanComputeApp::submitFrameDependencies(std::vector<VkSemaphore> &waitSemaphores,
+                                               std::vector<VkPipelineStageFlags> &waitStages)
 {
-    vkEndCommandBuffer(commandBuffer);
+    if (computeCommandBuffers.empty())
+        return;
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
+    // Submission order on the graphics queue does not reach the compute queue, so compute
+    // waits for uploads in flight. In practice that is the init batch, on the first frame.
+    if (hasAsyncCompute())
+    {
+        uploadBatch.waitIdle();
+    }
 
-    vkQueueSubmit(computeQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(computeQueue);
+    // The frame's fence has signalled, and the graphics work it guards waited on this
+    // command buffer, so it is safe to re-record
+    VkCommandBuffer commandBuffer = computeCommandBuffers[currentFrame];
+    vkResetCommandBuffer(commandBuffer, 0);
 
-    vkFreeCommandBuffers(device, computeCommandPool, 1, &commandBuffer);
-}
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-void VulkanComputeApp::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-                                    VkBuffer &buffer, VkDeviceMemory &bufferMemory)
-{
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size;
-    bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to begin recording compute command buffer!");
+    }
 
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+    // Compute is submitted first, so it resets the frame's timestamp queries. The graphics
+    // submission waits on it below, which orders the reset before any graphics zone.
+    bool resetTimestamps = gpuProfiler.recordReset(commandBuffer);
+
+    uint32_t computeZone = gpuProfiler.beginZone(commandBuffer, "Compute", GpuQueue::Compute);
+    bool hasWork = recordComputeCommands(commandBuffer);
+    gpuProfiler.endZone(commandBuffer, computeZone);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
     {
-        throw std::runtime_error("Failed to create buffer!");
+        throw std::runtime_error("Failed to record compute command buffer!");
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+    if (!hasWork && !resetTimestamps)
+        return;
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &computeFinishedSemaphores[currentFrame];
 
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+    if (vkQueueSubmit(computeQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
     {
-        throw std::runtime_error("Failed to allocate buffer memory!");
+        throw std::runtime_error("Failed to submit compute command buffer!");
     }
 
-    vkBindBufferMemory(device, buffer, bufferMemory, 0);
+    waitSemaphores.push_back(computeFinishedSemaphores[currentFrame]);
+    waitStages.push_back(computeWaitStage);
 }
 
-void VulkanComputeApp::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkQueue queue, VkCommandPool pool)
+VkCommandBuffer VulkanComputeApp::beginSingleTimeCommands()
 {
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = pool;
+    allocInfo.commandPool = computeCommandPool;
     allocInfo.commandBufferCount = 1;
 
     VkCommandBuffer commandBuffer;
@@ -182,10 +188,11 @@ void VulkanComputeApp::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDevi
 
     vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
-    VkBufferCopy copyRegion{};
-    copyRegion.size = size;
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    return commandBuffer;
+}
 
+void VulkanComputeApp::endSingleTimeCommands(VkCommandBuffer commandBuffer)
+{
     vkEndCommandBuffer(commandBuffer);
 
     VkSubmitInfo submitInfo{};
@@ -193,8 +200,18 @@ void VulkanComputeApp::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDevi
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(queue);
+    // Wait for this submission only, not for everything else on the queue
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create fence!");
+    }
 
-    vkFreeCommandBuffers(device, pool, 1, &commandBuffer);
+    vkQueueSubmit(computeQueue, 1, &submitInfo, fence);
+    vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(device, fence, nullptr);
+
+    vkFreeCommandBuffers(device, computeCommandPool, 1, &commandBuffer);
 }
@@ -10,15 +10,30 @@ public:
 protected:
     VkQueue computeQueue = VK_NULL_HANDLE;
     VkCommandPool computeCommandPool = VK_NULL_HANDLE;
+    // Equal when the device has no dedicated compute family
+    uint32_t graphicsQueueFamily = 0;
+    uint32_t computeQueueFamily = 0;
+
+    // Per-frame compute submission; graphics waits on computeFinishedSemaphores at computeWaitStage
+    std::vector<VkCommandBuffer> computeCommandBuffers;
+    std::vector<VkSemaphore> computeFinishedSemaphores;
+    VkPipelineStageFlags computeWaitStage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
 
     virtual void initVulkan() override;
     virtual void createLogicalDevice();
     void createComputeCommandPool();
+    void createComputeFrameResources();
+
+    // True when compute runs on its own queue family. Buffers shared with graphics then need
+    // queue family ownership transfers between computeQueueFamily and graphicsQueueFamily.
+    bool hasAsyncCompute() const { return computeQueueFamily != graphicsQueueFamily; }
+
+    // Records this frame's compute work into a command buffer submitted to computeQueue ahead
+    // of the graphics submission. Return false when there is nothing to submit.
+    virtual bool recordComputeCommands(VkCommandBuffer /*commandBuffer*/) { return false; }
+    void submitFrameDependencies(std::vector<VkSemaphore> &waitSemaphores,
+                                 std::vector<VkPipelineStageFlags> &waitStages) override;
 
     VkCommandBuffer beginSingleTimeCommands();
     void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-
-    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-                      VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkQueue queue, VkCommandPool pool);
 };
@@ -7,14 +7,17 @@
 class HelloTriangleApp : public VulkanApp {
   public:
     HelloTriangleApp(int width, int height, const char* title) : VulkanApp(width, height, title, VULKANAPP_GETSHADERDIR) {
+        // The triangle never changes, so each image's commands are recorded once
+        setStaticCommandBuffers(true);
     }
 };
 
-int main() {
+int main(int argc, char** argv) {
     const int WIDTH = 800;
     const int HEIGHT = 600;
 
     HelloTriangleApp app(WIDTH, HEIGHT, "Vulkan Hello Triangle");
+    app.parseArgs(argc, argv);
     app.init();
 
     try {
@@ -57,6 +57,9 @@ public:
             {{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},  // Top right (green)
             {{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}  // Top left (blue)
         };
+
+        // Nothing is animated, so each image's commands are recorded once
+        setStaticCommandBuffers(true);
     }
 
     // Record draw commands for this example
@@ -80,47 +83,16 @@ protected:
     // Override cleanup to clean up vertex buffer
     void cleanup() override
     {
-        vkDestroyBuffer(device, vertexBuffer, nullptr);
-        vkFreeMemory(device, vertexBufferMemory, nullptr);
+        destroyBuffer(vertexBuffer, vertexBufferAllocation);
         VulkanApp::cleanup();
     }
 
     // Override createGraphicsPipeline to use vertex buffer
     void createGraphicsPipeline() override
     {
-        std::vector<char> vertShaderCode;
-        std::vector<char> fragShaderCode;
-
-        try
-        {
-            // Try to compile shaders at runtime
-            std::cout << "Attempting to compile shaders at runtime..." << std::endl;
-            vertShaderCode = compileShader("shader.vert", VK_SHADER_STAGE_VERTEX_BIT);
-            fragShaderCode = compileShader("shader.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
-            std::cout << "Successfully compiled shaders!" << std::endl;
-        }
-        catch (const std::exception &e)
-        {
-            // If runtime compilation fails, try to read the shader files directly
-            std::cout << "Runtime shader compilation failed: " << e.what() << std::endl;
-            std::cout << "Trying to read shader files directly..." << std::endl;
-
-            try
-            {
-                vertShaderCode = readFile("shader.vert.spv");
-                fragShaderCode = readFile("shader.frag.spv");
-                std::cout << "Successfully read shader files!" << std::endl;
-            }
-            catch (const std::exception &e)
-            {
-                std::cerr << "Failed to read shader files: " << e.what() << std::endl;
-                throw; // Re-throw the exception if we can't read the files either
-            }
-        }
-
-        // Create shader modules
-        VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-        VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+        // Shader modules are cached, so rebuilding the pipeline never recompiles
+        VkShaderModule vertShaderModule = loadShaderModule("shader.vert", VK_SHADER_STAGE_VERTEX_BIT);
+        VkShaderModule fragShaderModule = loadShaderModule("shader.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
 
         // Shader stage creation
         VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
@@ -155,25 +127,17 @@ protected:
         inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
         inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-        // Viewport and scissor
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = (float)swapChainExtent.width;
-        viewport.height = (float)swapChainExtent.height;
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-
-        VkRect2D scissor{};
-        scissor.offset = {0, 0};
-        scissor.extent = swapChainExtent;
-
+        // Viewport and scissor are dynamic so the pipeline survives swapchain resizes
         VkPipelineViewportStateCreateInfo viewportState{};
         viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewport;
         viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
+
+        std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicState{};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicState.pDynamicStates = dynamicStates.data();
 
         // Rasterizer
         VkPipelineRasterizationStateCreateInfo rasterizer{};
@@ -223,62 +187,36 @@ protected:
         pipelineInfo.pRasterizationState = &rasterizer;
         pipelineInfo.pMultisampleState = &multisampling;
         pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicState;
         pipelineInfo.layout = _pipelineLayout;
         pipelineInfo.renderPass = renderPass;
         pipelineInfo.subpass = 0;
 
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
+        if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
         {
             throw std::runtime_error("Failed to create graphics pipeline!");
         }
-
-        // Cleanup shader modules
-        vkDestroyShaderModule(device, fragShaderModule, nullptr);
-        vkDestroyShaderModule(device, vertShaderModule, nullptr);
     }
 
     // Create vertex buffer
     void createVertexBuffer()
     {
-        VkBufferCreateInfo bufferInfo{};
-        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferInfo.size = sizeof(vertices[0]) * vertices.size();
-        bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        if (vkCreateBuffer(device, &bufferInfo, nullptr, &vertexBuffer) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to create vertex buffer!");
-        }
-
-        VkMemoryRequirements memRequirements;
-        vkGetBufferMemoryRequirements(device, vertexBuffer, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        if (vkAllocateMemory(device, &allocInfo, nullptr, &vertexBufferMemory) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to allocate vertex buffer memory!");
-        }
-
-        vkBindBufferMemory(device, vertexBuffer, vertexBufferMemory, 0);
+        VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
+        createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     vertexBuffer, vertexBufferAllocation);
 
-        void *data;
-        vkMapMemory(device, vertexBufferMemory, 0, bufferInfo.size, 0, &data);
-        memcpy(data, vertices.data(), (size_t)bufferInfo.size);
-        vkUnmapMemory(device, vertexBufferMemory);
+        // Host-visible allocator memory stays mapped
+        memcpy(vertexBufferAllocation.mapped, vertices.data(), (size_t)bufferSize);
     }
 
 private:
     std::vector<Vertex> vertices;
     VkBuffer vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
+    MemoryAllocation vertexBufferAllocation;
 };
 
-int main()
+int main(int argc, char **argv)
 {
     const int WIDTH = 800;
     const int HEIGHT = 600;
@@ -287,6 +225,7 @@ int main()
     try
     {
         VertexBufferApp app(WIDTH, HEIGHT, APP_NAME);
+        app.parseArgs(argc, argv);
         app.init();
         app.run();
     }
@@ -49,23 +49,20 @@ public:
         std::cout << std::endl;
 
         VkBuffer inBuffer;
-        VkDeviceMemory inBufferMemory;
+        MemoryAllocation inBufferAllocation;
         createBuffer(sizeof(float) * NUM_ELEMENTS,
                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     inBuffer, inBufferMemory);
+                     inBuffer, inBufferAllocation);
 
         VkBuffer outBuffer;
-        VkDeviceMemory outBufferMemory;
+        MemoryAllocation outBufferAllocation;
         createBuffer(sizeof(float) * NUM_ELEMENTS,
                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     outBuffer, outBufferMemory);
+                     outBuffer, outBufferAllocation);
 
-        void *mapped;
-        vkMapMemory(device, inBufferMemory, 0, VK_WHOLE_SIZE, 0, &mapped);
-        memcpy(mapped, inData.data(), sizeof(float) * NUM_ELEMENTS);
-        vkUnmapMemory(device, inBufferMemory);
+        memcpy(inBufferAllocation.mapped, inData.data(), sizeof(float) * NUM_ELEMENTS);
 
         VkDescriptorSetLayoutBinding bindings[2]{};
         bindings[0].binding = 0;
@@ -111,7 +108,7 @@ public:
         pipelineInfo.stage = stage;
         pipelineInfo.layout = pipelineLayout;
         VkPipeline pipeline;
-        vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
 
         VkDescriptorPoolSize poolSize{};
         poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
@@ -159,15 +156,27 @@ public:
 
         vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
 
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-        vkCmdDispatch(commandBuffer, NUM_ELEMENTS, 1, 1);
-        endSingleTimeCommands(commandBuffer);
+        // Headless runs repeat the dispatch so it can be benchmarked like a frame. Each
+        // submission waits for the queue, so slot 0 of the GPU profiler is always free.
+        uint32_t iterations = (headless || benchmarkFrameCount > 0) ? headlessFrameCount : 1;
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            double submitStartUs = profilerClockMicros();
+            gpuProfiler.beginFrame(0);
+
+            VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+            gpuProfiler.recordReset(commandBuffer);
+            {
+                GpuZone zone(gpuProfiler, commandBuffer, "Dispatch", GpuQueue::Compute);
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+                vkCmdDispatch(commandBuffer, NUM_ELEMENTS, 1, 1);
+            }
+            endSingleTimeCommands(commandBuffer);
+            recordFrameStats(submitStartUs);
+        }
 
-        vkMapMemory(device, outBufferMemory, 0, VK_WHOLE_SIZE, 0, &mapped);
-        memcpy(outData.data(), mapped, sizeof(float) * NUM_ELEMENTS);
-        vkUnmapMemory(device, outBufferMemory);
+        memcpy(outData.data(), outBufferAllocation.mapped, sizeof(float) * NUM_ELEMENTS);
 
         std::cout << "Data after compute shader execution:" << std::endl;
         for (float f : outData)
@@ -181,10 +190,10 @@ public:
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
         vkDestroyShaderModule(device, shaderModule, nullptr);
         vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
-        vkDestroyBuffer(device, inBuffer, nullptr);
-        vkFreeMemory(device, inBufferMemory, nullptr);
-        vkDestroyBuffer(device, outBuffer, nullptr);
-        vkFreeMemory(device, outBufferMemory, nullptr);
+        destroyBuffer(inBuffer, inBufferAllocation);
+        destroyBuffer(outBuffer, outBufferAllocation);
+
+        writeProfiles();
 #ifdef ENABLE_RENDERDOC_CAPTURE
         if (rdoc_api)
         {
@@ -198,25 +207,39 @@ public:
 #endif
     }
 
-    void init()
+protected:
+    // Runs inside the base init(), after initWindow() and within its startup report
+    void initVulkan() override
     {
-        // Initialize GLFW and create a hidden window so that the surface
-        // extension is enabled. This avoids validation errors when the
-        // base helpers query for presentation support.
-        initWindow();
-        glfwHideWindow(window);
-        createInstance();
-        setupDebugMessenger();
-        createSurface();
-        pickPhysicalDevice();
-        createLogicalDevice();
-        createComputeCommandPool();
+        // The base init created a window so that the surface extension is
+        // enabled. This avoids validation errors when the base helpers query
+        // for presentation support. Keep it hidden; in headless mode no window
+        // or surface is created at all.
+        if (window)
+            glfwHideWindow(window);
+        CPU_ZONE_CALL("createInstance", createInstance());
+        CPU_ZONE_CALL("setupDebugMessenger", setupDebugMessenger());
+        CPU_ZONE_CALL("createSurface", createSurface());
+        CPU_ZONE_CALL("pickPhysicalDevice", pickPhysicalDevice());
+        CPU_ZONE_CALL("createLogicalDevice", createLogicalDevice());
+        CPU_ZONE_CALL("createMemoryAllocator", createMemoryAllocator());
+        CPU_ZONE_CALL("createPipelineCache", createPipelineCache());
+        CPU_ZONE_CALL("createComputeCommandPool", createComputeCommandPool());
+
+        // There is no graphics command pool here, so calibrate the timestamps on the compute queue
+        if (!gpuProfilePath.empty() || !statsPath.empty())
+        {
+            CPU_ZONE("createGpuProfiler");
+            gpuProfiler.init(physicalDevice, device, 1, computeQueueFamily, computeQueueFamily);
+            gpuProfiler.calibrate(computeQueue, computeCommandPool);
+        }
     }
 };
 
-int main()
+int main(int argc, char **argv)
 {
     ComputeExample app;
+    app.parseArgs(argc, argv);
     app.init();
     app.runExample();
     return 0;
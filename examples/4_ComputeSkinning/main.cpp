@@ -15,7 +15,6 @@ constexpr bool USE_COMPUTE_SKINNING = true;
 #include <cstdlib>
 #include <vector>
 #include <array>
-#include <chrono>
 #include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -121,7 +120,7 @@ protected:
     // Override initVulkan to create descriptor layout before pipeline
     void initVulkan() override
     {
-        VulkanApp::initVulkan();
+        VulkanComputeApp::initVulkan();
 
         // Resources that depend on the command pool created in base init
         createVertexBuffer();
@@ -129,28 +128,18 @@ protected:
         createTextureImage();
         createTextureImageView();
         createTextureSampler();
-        createUniformBuffer();
         createDescriptorPool();
         createDescriptorSets();
 
         if (USE_COMPUTE_SKINNING)
         {
+            // Each frame's vertex buffer is filled by a dispatch on the compute queue
             createComputeResources();
-            // Run compute shader once to populate the vertex buffer
-            runComputeSkinning(0.0f);
         }
         else
         {
             populateVertexBufferNoSkinning();
         }
-        startTime = std::chrono::steady_clock::now();
-
-        // Command buffers were created in base init before we had vertex data
-        // so recreate them now
-        vkFreeCommandBuffers(device, commandPool,
-                             static_cast<uint32_t>(commandBuffers.size()),
-                             commandBuffers.data());
-        createCommandBuffers();
     }
 
     // Override cleanup to clean up resources
@@ -158,8 +147,7 @@ protected:
     {
         vkDestroySampler(device, textureSampler, nullptr);
         vkDestroyImageView(device, textureImageView, nullptr);
-        vkDestroyImage(device, textureImage, nullptr);
-        vkFreeMemory(device, textureImageMemory, nullptr);
+        destroyImage(textureImage, textureImageAllocation);
 
         vkDestroyDescriptorPool(device, descriptorPool, nullptr);
         vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
@@ -168,19 +156,14 @@ protected:
         vkDestroyPipeline(device, computePipeline, nullptr);
         vkDestroyPipelineLayout(device, computePipelineLayout, nullptr);
         vkDestroyDescriptorSetLayout(device, computeDescriptorSetLayout, nullptr);
-        vkDestroyBuffer(device, computeInputBuffer, nullptr);
-        vkFreeMemory(device, computeInputBufferMemory, nullptr);
-        vkDestroyBuffer(device, boneBuffer, nullptr);
-        vkFreeMemory(device, boneBufferMemory, nullptr);
+        destroyBuffer(computeInputBuffer, computeInputBufferAllocation);
 
-        vkDestroyBuffer(device, uniformBuffer, nullptr);
-        vkFreeMemory(device, uniformBufferMemory, nullptr);
+        destroyBuffer(indexBuffer, indexBufferAllocation);
 
-        vkDestroyBuffer(device, indexBuffer, nullptr);
-        vkFreeMemory(device, indexBufferMemory, nullptr);
-
-        vkDestroyBuffer(device, vertexBuffer, nullptr);
-        vkFreeMemory(device, vertexBufferMemory, nullptr);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            destroyBuffer(vertexBuffers[i], vertexBufferAllocations[i]);
+        }
 
         VulkanApp::cleanup();
     }
@@ -188,29 +171,15 @@ protected:
     // Create graphics pipeline with vertex input and descriptor set layout
     void createGraphicsPipeline() override
     {
-        createDescriptorSetLayout();
-
-        std::vector<char> vertShaderCode;
-        std::vector<char> fragShaderCode;
-
-        try
+        // The descriptor set layout is created once and reused if the pipeline is rebuilt
+        if (descriptorSetLayout == VK_NULL_HANDLE)
         {
-            std::cout << "Attempting to compile shaders at runtime..." << std::endl;
-            vertShaderCode = compileShader("shader.vert", VK_SHADER_STAGE_VERTEX_BIT);
-            fragShaderCode = compileShader("shader.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
-            std::cout << "Successfully compiled shaders!" << std::endl;
+            createDescriptorSetLayout();
         }
-        catch (const std::exception &e)
-        {
-            std::cout << "Runtime shader compilation failed: " << e.what() << std::endl;
-            std::cout << "Trying to read shader files directly..." << std::endl;
 
-            vertShaderCode = readFile("shader.vert.spv");
-            fragShaderCode = readFile("shader.frag.spv");
-        }
-
-        VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-        VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+        // Shader modules are cached, so rebuilding the pipeline never recompiles
+        VkShaderModule vertShaderModule = loadShaderModule("shader.vert", VK_SHADER_STAGE_VERTEX_BIT);
+        VkShaderModule fragShaderModule = loadShaderModule("shader.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
 
         VkPipelineShaderStageCreateInfo vertStage{};
         vertStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -241,24 +210,17 @@ protected:
         inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
         inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = static_cast<float>(swapChainExtent.width);
-        viewport.height = static_cast<float>(swapChainExtent.height);
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-
-        VkRect2D scissor{};
-        scissor.offset = {0, 0};
-        scissor.extent = swapChainExtent;
-
+        // Viewport and scissor are dynamic so the pipeline survives swapchain resizes
         VkPipelineViewportStateCreateInfo viewportState{};
         viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewport;
         viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
+
+        std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicState{};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicState.pDynamicStates = dynamicStates.data();
 
         VkPipelineRasterizationStateCreateInfo rasterizer{};
         rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -306,46 +268,62 @@ protected:
         pipelineInfo.pRasterizationState = &rasterizer;
         pipelineInfo.pMultisampleState = &multisampling;
         pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicState;
         pipelineInfo.layout = _pipelineLayout;
         pipelineInfo.renderPass = renderPass;
         pipelineInfo.subpass = 0;
 
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
+        if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
         {
             throw std::runtime_error("Failed to create graphics pipeline!");
         }
+    }
+
+    // Skin this frame's vertices on the compute queue; graphics waits on the compute semaphore
+    bool recordComputeCommands(VkCommandBuffer commandBuffer) override
+    {
+        if (!USE_COMPUTE_SKINNING)
+            return false;
 
-        vkDestroyShaderModule(device, fragShaderModule, nullptr);
-        vkDestroyShaderModule(device, vertShaderModule, nullptr);
+        float time = static_cast<float>(getAnimationTime());
+        float angle = glm::radians(45.0f) * std::sin(time);
+        recordComputeSkinning(commandBuffer, angle);
+        return true;
     }
 
-    // Record draw commands each frame
-    void recordRenderCommands(VkCommandBuffer commandBuffer) override
+    // Acquire the skinned vertex buffer from the compute queue family before drawing
+    void recordPreRenderPassCommands(VkCommandBuffer commandBuffer) override
     {
-        // Update skinning each frame if enabled
-        if (USE_COMPUTE_SKINNING)
+        if (USE_COMPUTE_SKINNING && hasAsyncCompute())
         {
-            auto now = std::chrono::steady_clock::now();
-            float time = std::chrono::duration<float>(now - startTime).count();
-            float angle = glm::radians(45.0f) * std::sin(time);
-            runComputeSkinning(angle);
+            VkBufferMemoryBarrier2 acquire = vertexBufferOwnershipBarrier();
+            acquire.srcStageMask = VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
+            acquire.dstStageMask = VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
+            acquire.dstAccessMask = VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT;
+
+            BarrierBuilder barriers(cmdPipelineBarrier2);
+            barriers.buffer(acquire);
+            barriers.flush(commandBuffer);
         }
+    }
 
-        updateUniformBuffer();
+    // Record draw commands each frame
+    void recordRenderCommands(VkCommandBuffer commandBuffer) override
+    {
+        uint32_t cameraOffset = updateUniformBuffer();
 
-        VkBuffer vertexBuffers[] = {vertexBuffer};
+        VkBuffer frameVertexBuffers[] = {vertexBuffers[currentFrame]};
         VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, frameVertexBuffers, offsets);
         vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
         vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                _pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+                                _pipelineLayout, 0, 1, &descriptorSet, 1, &cameraOffset);
         vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
     }
 
-    // Dispatch compute shader to skin vertices
-    void runComputeSkinning(float angle)
+    // Record the compute dispatch that skins vertices into this frame's vertex buffer
+    void recordComputeSkinning(VkCommandBuffer cb, float angle)
     {
-        void *mapped;
         glm::mat4 world = glm::rotate(glm::mat4(1.0f), glm::radians(-30.0f), glm::vec3(1, 0, 0)) *
                           glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(0, 1, 0));
         std::array<glm::mat4, 2> boneMats = {
@@ -354,58 +332,55 @@ protected:
                 glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0, 0, 1)) *
                 glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f))};
 
-        vkMapMemory(device, boneBufferMemory, 0, sizeof(glm::mat4) * 2, 0, &mapped);
-        memcpy(mapped, boneMats.data(), sizeof(glm::mat4) * 2);
-        vkUnmapMemory(device, boneBufferMemory);
-
-        VkCommandBufferAllocateInfo cbAlloc{};
-        cbAlloc.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        cbAlloc.commandPool = commandPool;
-        cbAlloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        cbAlloc.commandBufferCount = 1;
-        VkCommandBuffer cb;
-        vkAllocateCommandBuffers(device, &cbAlloc, &cb);
-
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        vkBeginCommandBuffer(cb, &beginInfo);
-        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
-        vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, computePipelineLayout, 0, 1, &computeDescriptorSet, 0, nullptr);
-        vkCmdDispatch(cb, static_cast<uint32_t>(computeVertices.size()), 1, 1);
-
-        // Ensure compute writes to the vertex buffer are visible to the
-        // graphics pipeline when it reads the data as vertex attributes.
-        VkBufferMemoryBarrier bufferBarrier{};
-        bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-        bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-        bufferBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
-        bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        bufferBarrier.buffer = vertexBuffer;
-        bufferBarrier.offset = 0;
-        bufferBarrier.size = VK_WHOLE_SIZE;
-        vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr,
-                             1, &bufferBarrier, 0, nullptr);
-
-        vkEndCommandBuffer(cb);
-
-        VkSubmitInfo submit{};
-        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submit.commandBufferCount = 1;
-        submit.pCommandBuffers = &cb;
-        vkQueueSubmit(graphicsQueue, 1, &submit, VK_NULL_HANDLE);
-        vkQueueWaitIdle(graphicsQueue);
-
-        vkFreeCommandBuffers(device, commandPool, 1, &cb);
+        uint32_t boneOffset = uploadRing.push(boneMats);
+
+        // Every vertex is rewritten, so the previous contents (and their owner) are discarded.
+        // The frame fence already guarantees the last draw that read this buffer has finished.
+        {
+            GpuZone zone(gpuProfiler, cb, "Skinning", GpuQueue::Compute);
+            vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+            vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, computePipelineLayout, 0, 1, &computeDescriptorSets[currentFrame], 1, &boneOffset);
+            vkCmdDispatch(cb, static_cast<uint32_t>(computeVertices.size()), 1, 1);
+        }
+
+        // On a dedicated compute family, release the buffer to graphics. The semaphore
+        // makes the writes available; the matching acquire happens in the graphics queue.
+        if (hasAsyncCompute())
+        {
+            VkBufferMemoryBarrier2 release = vertexBufferOwnershipBarrier();
+            release.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+            release.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+            release.dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+
+            BarrierBuilder barriers(cmdPipelineBarrier2);
+            barriers.buffer(release);
+            barriers.flush(cb);
+        }
+    }
+
+    // Queue family ownership transfer of this frame's vertex buffer from compute to graphics;
+    // stages and access masks are left to the release and the acquire
+    VkBufferMemoryBarrier2 vertexBufferOwnershipBarrier() const
+    {
+        VkBufferMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+        barrier.srcQueueFamilyIndex = computeQueueFamily;
+        barrier.dstQueueFamilyIndex = graphicsQueueFamily;
+        barrier.buffer = vertexBuffers[currentFrame];
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        return barrier;
     }
 
-    // Create vertex buffer
+    // Create one vertex buffer per frame in flight so skinning the next frame never waits on
+    // the draw still reading the previous one
     void createVertexBuffer()
     {
         VkDeviceSize bufferSize = sizeof(Vertex) * computeVertices.size();
-        createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffers[i], vertexBufferAllocations[i]);
+        }
     }
 
     // Populate vertex buffer directly without running the compute shader
@@ -420,21 +395,22 @@ protected:
 
         VkDeviceSize bufferSize = sizeof(Vertex) * verts.size();
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     stagingBuffer, stagingBufferMemory);
-
-        void *data;
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, verts.data(), static_cast<size_t>(bufferSize));
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+        // Unified memory is written directly; otherwise the vertices are staged once and
+        // copied into every frame's buffer
+        if (vertexBufferAllocations[0].mapped)
+        {
+            for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+            {
+                uploadBatch.uploadBuffer(vertexBuffers[i], vertexBufferAllocations[i], verts.data(), bufferSize);
+            }
+            return;
+        }
 
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+        StagedData staged = uploadBatch.stage(verts.data(), bufferSize);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            uploadBatch.copyBuffer(staged.buffer, vertexBuffers[i], bufferSize, staged.offset);
+        }
     }
 
     // Create index buffer
@@ -442,21 +418,9 @@ protected:
     {
         VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        void *data;
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, indices.data(), (size_t)bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
+        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferAllocation);
 
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
-
-        copyBuffer(stagingBuffer, indexBuffer, bufferSize);
-
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+        uploadBatch.uploadBuffer(indexBuffer, indexBufferAllocation, indices.data(), bufferSize);
     }
 
     // Create texture image
@@ -469,9 +433,10 @@ protected:
 
         std::vector<unsigned char> pixels(texWidth * texHeight * texChannels);
 
-        // Generate a checkerboard pattern
-        for (int y = 0; y < texHeight; y++)
+        // Generate a checkerboard pattern, with rows split across the job system
+        auto generateRow = [&](uint32_t row)
         {
+            int y = static_cast<int>(row);
             for (int x = 0; x < texWidth; x++)
             {
                 bool isWhite = ((x / 32) + (y / 32)) % 2 == 0;
@@ -487,42 +452,24 @@ protected:
                 pixels[pixelIndex + 2] = b;
                 pixels[pixelIndex + 3] = a;
             }
-        }
+        };
+        jobSystem.parallelFor(static_cast<uint32_t>(texHeight), generateRow, 16);
 
         VkDeviceSize imageSize = texWidth * texHeight * texChannels;
 
-        // Create staging buffer
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+        // Create image with a full mip chain; each level is blitted from the one above it
+        textureMipLevels = getMipLevelCount(VK_FORMAT_R8G8B8A8_SRGB, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+        createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageAllocation, textureMipLevels);
 
-        // Copy pixel data to staging buffer
-        void *data;
-        vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, pixels.data(), static_cast<size_t>(imageSize));
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        // Create image
-        createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
-
-        // Transition image layout for copy
-        transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-        // Copy buffer to image
-        copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-
-        // Transition image layout for shader access
-        transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-        // Cleanup staging buffer
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+        // Staged, copied and transitioned for shader access with the rest of the init uploads
+        uploadBatch.uploadImage(textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight),
+                                pixels.data(), imageSize, textureMipLevels);
     }
 
     // Create texture image view
     void createTextureImageView()
     {
-        textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB);
+        textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB, textureMipLevels);
     }
 
     // Create texture sampler
@@ -548,7 +495,7 @@ protected:
         samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerInfo.mipLodBias = 0.0f;
         samplerInfo.minLod = 0.0f;
-        samplerInfo.maxLod = 0.0f;
+        samplerInfo.maxLod = static_cast<float>(textureMipLevels);
 
         if (vkCreateSampler(device, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS)
         {
@@ -556,21 +503,13 @@ protected:
         }
     }
 
-    void createUniformBuffer()
-    {
-        VkDeviceSize bufferSize = sizeof(CameraUBO);
-        createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     uniformBuffer, uniformBufferMemory);
-    }
-
-    void updateUniformBuffer()
+    // Writes this frame's camera into the upload ring and returns its dynamic offset
+    uint32_t updateUniformBuffer()
     {
         CameraUBO ubo{};
 
         // Slowly rotate the view around the cylinder center.
-        auto now = std::chrono::steady_clock::now();
-        float time = std::chrono::duration<float>(now - startTime).count();
+        float time = static_cast<float>(getAnimationTime());
         float angle = glm::radians(20.0f) * time; // 20 degrees per second
 
         const float radius = 2.5f; // distance from the center
@@ -585,10 +524,7 @@ protected:
         proj[1][1] *= -1.0f;
         ubo.viewProj = proj * view;
 
-        void *data;
-        vkMapMemory(device, uniformBufferMemory, 0, sizeof(ubo), 0, &data);
-        memcpy(data, &ubo, sizeof(ubo));
-        vkUnmapMemory(device, uniformBufferMemory);
+        return uploadRing.push(ubo);
     }
 
     // Create descriptor set layout
@@ -603,7 +539,7 @@ protected:
 
         VkDescriptorSetLayoutBinding uboLayoutBinding{};
         uboLayoutBinding.binding = 1;
-        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         uboLayoutBinding.descriptorCount = 1;
         uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
@@ -627,7 +563,7 @@ protected:
         samplerSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         samplerSize.descriptorCount = 1;
         VkDescriptorPoolSize uboSize{};
-        uboSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uboSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         uboSize.descriptorCount = 1;
 
         std::array<VkDescriptorPoolSize, 2> poolSizes{samplerSize, uboSize};
@@ -663,7 +599,8 @@ protected:
         imageInfo.imageView = textureImageView;
         imageInfo.sampler = textureSampler;
 
-        VkDescriptorBufferInfo uboInfo{uniformBuffer, 0, sizeof(CameraUBO)};
+        // Bound with a per-frame dynamic offset into the upload ring
+        VkDescriptorBufferInfo uboInfo{uploadRing.getBuffer(), 0, sizeof(CameraUBO)};
 
         std::array<VkWriteDescriptorSet, 2> writes{};
         writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -676,7 +613,7 @@ protected:
         writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         writes[1].dstSet = descriptorSet;
         writes[1].dstBinding = 1;
-        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writes[1].descriptorCount = 1;
         writes[1].pBufferInfo = &uboInfo;
 
@@ -689,16 +626,9 @@ protected:
         VkDeviceSize inSize = sizeof(computeVertices[0]) * computeVertices.size();
         createBuffer(inSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     computeInputBuffer, computeInputBufferMemory);
+                     computeInputBuffer, computeInputBufferAllocation);
 
-        void *mapped;
-        vkMapMemory(device, computeInputBufferMemory, 0, inSize, 0, &mapped);
-        memcpy(mapped, computeVertices.data(), static_cast<size_t>(inSize));
-        vkUnmapMemory(device, computeInputBufferMemory);
-
-        createBuffer(sizeof(glm::mat4) * 2, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     boneBuffer, boneBufferMemory);
+        memcpy(computeInputBufferAllocation.mapped, computeVertices.data(), static_cast<size_t>(inSize));
 
         VkDescriptorSetLayoutBinding b0{};
         b0.binding = 0;
@@ -712,7 +642,7 @@ protected:
         b1.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
         VkDescriptorSetLayoutBinding b2{};
         b2.binding = 2;
-        b2.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        b2.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         b2.descriptorCount = 1;
         b2.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
         std::array<VkDescriptorSetLayoutBinding, 3> bindings{b0, b1, b2};
@@ -728,13 +658,7 @@ protected:
         plInfo.pSetLayouts = &computeDescriptorSetLayout;
         vkCreatePipelineLayout(device, &plInfo, nullptr, &computePipelineLayout);
 
-        auto code = compileShader("comp.comp", VK_SHADER_STAGE_COMPUTE_BIT);
-        VkShaderModuleCreateInfo modInfo{};
-        modInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        modInfo.codeSize = code.size();
-        modInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
-        VkShaderModule shaderModule;
-        vkCreateShaderModule(device, &modInfo, nullptr, &shaderModule);
+        VkShaderModule shaderModule = loadShaderModule("comp.comp", VK_SHADER_STAGE_COMPUTE_BIT);
 
         VkPipelineShaderStageCreateInfo stage{};
         stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -746,153 +670,62 @@ protected:
         cpInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
         cpInfo.stage = stage;
         cpInfo.layout = computePipelineLayout;
-        vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &cpInfo, nullptr, &computePipeline);
-
-        vkDestroyShaderModule(device, shaderModule, nullptr);
+        vkCreateComputePipelines(device, pipelineCache, 1, &cpInfo, nullptr, &computePipeline);
 
         VkDescriptorPoolSize poolSize{};
         poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        poolSize.descriptorCount = 2;
+        poolSize.descriptorCount = 2 * MAX_FRAMES_IN_FLIGHT;
         VkDescriptorPoolSize boneSize{};
-        boneSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        boneSize.descriptorCount = 1;
+        boneSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        boneSize.descriptorCount = MAX_FRAMES_IN_FLIGHT;
         std::array<VkDescriptorPoolSize, 2> poolSizes{poolSize, boneSize};
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
         poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
         poolInfo.pPoolSizes = poolSizes.data();
-        poolInfo.maxSets = 1;
+        poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
         vkCreateDescriptorPool(device, &poolInfo, nullptr, &computeDescriptorPool);
 
+        std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> setLayouts;
+        setLayouts.fill(computeDescriptorSetLayout);
         VkDescriptorSetAllocateInfo dsAlloc{};
         dsAlloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
         dsAlloc.descriptorPool = computeDescriptorPool;
-        dsAlloc.descriptorSetCount = 1;
-        dsAlloc.pSetLayouts = &computeDescriptorSetLayout;
-        vkAllocateDescriptorSets(device, &dsAlloc, &computeDescriptorSet);
-
-        VkDescriptorBufferInfo inInfo{computeInputBuffer, 0, inSize};
-        VkDescriptorBufferInfo outInfo{vertexBuffer, 0, sizeof(Vertex) * computeVertices.size()};
-        VkDescriptorBufferInfo boneInfo{boneBuffer, 0, sizeof(glm::mat4) * 2};
-        std::array<VkWriteDescriptorSet, 3> writes{};
-        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[0].dstSet = computeDescriptorSet;
-        writes[0].dstBinding = 0;
-        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        writes[0].descriptorCount = 1;
-        writes[0].pBufferInfo = &inInfo;
-        writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[1].dstSet = computeDescriptorSet;
-        writes[1].dstBinding = 1;
-        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        writes[1].descriptorCount = 1;
-        writes[1].pBufferInfo = &outInfo;
-        writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[2].dstSet = computeDescriptorSet;
-        writes[2].dstBinding = 2;
-        writes[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        writes[2].descriptorCount = 1;
-        writes[2].pBufferInfo = &boneInfo;
-        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
-    }
-
-    // Helper function to copy buffer
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
-    {
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = commandPool;
-        allocInfo.commandBufferCount = 1;
-
-        VkCommandBuffer commandBuffer;
-        vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-        vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-        VkBufferCopy copyRegion{};
-        copyRegion.size = size;
-        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-        vkEndCommandBuffer(commandBuffer);
-
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-
-        vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(graphicsQueue);
-
-        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
-    }
-
-    // Helper function to create image
-    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory)
-    {
-        VkImageCreateInfo imageInfo{};
-        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-        imageInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageInfo.extent.width = width;
-        imageInfo.extent.height = height;
-        imageInfo.extent.depth = 1;
-        imageInfo.mipLevels = 1;
-        imageInfo.arrayLayers = 1;
-        imageInfo.format = format;
-        imageInfo.tiling = tiling;
-        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        imageInfo.usage = usage;
-        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to create image!");
-        }
-
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(device, image, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+        dsAlloc.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());
+        dsAlloc.pSetLayouts = setLayouts.data();
+        vkAllocateDescriptorSets(device, &dsAlloc, computeDescriptorSets);
 
-        if (vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
+        // Sets differ only in the output buffer they skin into
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
         {
-            throw std::runtime_error("Failed to allocate image memory!");
+            VkDescriptorBufferInfo inInfo{computeInputBuffer, 0, inSize};
+            VkDescriptorBufferInfo outInfo{vertexBuffers[i], 0, sizeof(Vertex) * computeVertices.size()};
+            VkDescriptorBufferInfo boneInfo{uploadRing.getBuffer(), 0, sizeof(glm::mat4) * 2};
+            std::array<VkWriteDescriptorSet, 3> writes{};
+            writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[0].dstSet = computeDescriptorSets[i];
+            writes[0].dstBinding = 0;
+            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[0].descriptorCount = 1;
+            writes[0].pBufferInfo = &inInfo;
+            writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[1].dstSet = computeDescriptorSets[i];
+            writes[1].dstBinding = 1;
+            writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[1].descriptorCount = 1;
+            writes[1].pBufferInfo = &outInfo;
+            writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[2].dstSet = computeDescriptorSets[i];
+            writes[2].dstBinding = 2;
+            writes[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            writes[2].descriptorCount = 1;
+            writes[2].pBufferInfo = &boneInfo;
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
         }
-
-        vkBindImageMemory(device, image, imageMemory, 0);
-    }
-
-    // Helper function to copy buffer to image
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
-    {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferImageCopy region{};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = {0, 0, 0};
-        region.imageExtent = {width, height, 1};
-
-        vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-        endSingleTimeCommands(commandBuffer);
     }
 
     // Helper function to create image view
-    VkImageView createImageView(VkImage image, VkFormat format)
+    VkImageView createImageView(VkImage image, VkFormat format, uint32_t mipLevels)
     {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -901,7 +734,7 @@ protected:
         viewInfo.format = format;
         viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.levelCount = mipLevels;
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
 
@@ -914,64 +747,26 @@ protected:
         return imageView;
     }
 
-    // Helper function to begin single time commands
-    VkCommandBuffer beginSingleTimeCommands()
-    {
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = commandPool;
-        allocInfo.commandBufferCount = 1;
-
-        VkCommandBuffer commandBuffer;
-        vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-        vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-        return commandBuffer;
-    }
-
-    // Helper function to end single time commands
-    void endSingleTimeCommands(VkCommandBuffer commandBuffer)
-    {
-        vkEndCommandBuffer(commandBuffer);
-
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-
-        vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(graphicsQueue);
-
-        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
-    }
-
 private:
     // Vertex data
     std::vector<ComputeVertex> computeVertices;
     std::vector<uint16_t> indices;
 
-    std::chrono::steady_clock::time_point startTime;
-
     // Buffers
-    VkBuffer vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
+    VkBuffer vertexBuffers[MAX_FRAMES_IN_FLIGHT];
+    MemoryAllocation vertexBufferAllocations[MAX_FRAMES_IN_FLIGHT];
     VkBuffer indexBuffer;
-    VkDeviceMemory indexBufferMemory;
+    MemoryAllocation indexBufferAllocation;
 
     // Texture
     VkImage textureImage;
-    VkDeviceMemory textureImageMemory;
+    MemoryAllocation textureImageAllocation;
+    uint32_t textureMipLevels = 1;
     VkImageView textureImageView;
     VkSampler textureSampler;
 
     // Descriptor
-    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
     VkDescriptorPool descriptorPool;
     VkDescriptorSet descriptorSet;
 
@@ -980,18 +775,15 @@ private:
     VkPipelineLayout computePipelineLayout = VK_NULL_HANDLE;
     VkPipeline computePipeline = VK_NULL_HANDLE;
     VkDescriptorPool computeDescriptorPool = VK_NULL_HANDLE;
-    VkDescriptorSet computeDescriptorSet = VK_NULL_HANDLE;
+    VkDescriptorSet computeDescriptorSets[MAX_FRAMES_IN_FLIGHT] = {};
     VkBuffer computeInputBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory computeInputBufferMemory = VK_NULL_HANDLE;
-    VkBuffer boneBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory boneBufferMemory = VK_NULL_HANDLE;
-    VkBuffer uniformBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory uniformBufferMemory = VK_NULL_HANDLE;
+    MemoryAllocation computeInputBufferAllocation;
 };
 
-int main()
+int main(int argc, char **argv)
 {
     ComputeSkinningApp app(800, 600, "Compute Skinning Example");
+    app.parseArgs(argc, argv);
     app.init();
 
     try
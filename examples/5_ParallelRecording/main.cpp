@@ -0,0 +1,603 @@
+#include "vulkan_app.h"
+
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdlib>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <glm/glm.hpp>
+
+// Vertex structure with position and texture coordinates
+struct Vertex
+{
+    glm::vec2 pos;
+    glm::vec2 texCoord;
+
+    static VkVertexInputBindingDescription getBindingDescription()
+    {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(Vertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        return bindingDescription;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions()
+    {
+        std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+
+        // Position attribute
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[0].offset = offsetof(Vertex, pos);
+
+        // Texture coordinate attribute
+        attributeDescriptions[1].binding = 0;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[1].offset = offsetof(Vertex, texCoord);
+
+        return attributeDescriptions;
+    }
+};
+
+// Per-object push constants, matching ObjectData in shader.vert
+struct ObjectData
+{
+    glm::vec2 offset;
+    float scale;
+};
+
+// Draws a grid of textured quads, one draw call each, recorded on several threads
+class ParallelRecordingApp : public VulkanApp
+{
+public:
+    ParallelRecordingApp(int width, int height, const std::string &appName, uint32_t objectCount)
+        : VulkanApp(width, height, appName, VULKANAPP_GETSHADERDIR)
+    {
+        // Define vertices for a textured quad
+        vertices = {
+            {{-0.5f, -0.5f}, {0.0f, 0.0f}}, // Bottom left
+            {{0.5f, -0.5f}, {1.0f, 0.0f}},  // Bottom right
+            {{0.5f, 0.5f}, {1.0f, 1.0f}},   // Top right
+            {{-0.5f, 0.5f}, {0.0f, 1.0f}}   // Top left
+        };
+
+        // Define indices for the quad (two triangles)
+        indices = {
+            0, 1, 2, // First triangle
+            2, 3, 0  // Second triangle
+        };
+
+        // Lay the objects out on a square grid covering the viewport
+        uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(objectCount))));
+        float cellSize = 2.0f / columns;
+        objects.resize(objectCount);
+        for (uint32_t i = 0; i < objectCount; i++)
+        {
+            objects[i].offset = {-1.0f + cellSize * (i % columns + 0.5f), -1.0f + cellSize * (i / columns + 0.5f)};
+            objects[i].scale = cellSize * 0.8f;
+        }
+
+        // --record-threads overrides this
+        setRecordThreadCount(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // Times recording alone, without submitting, at 1, 2, 4, ... threads up to the hardware
+    // thread count, and prints recording throughput for each. The recorder is left with the
+    // configured thread count afterwards.
+    void runScalingBenchmark(uint32_t iterations)
+    {
+        vkDeviceWaitIdle(device);
+
+        uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<uint32_t> threadCounts;
+        for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+        {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(maxThreads);
+
+        VkCommandBufferInheritanceInfo inheritance{};
+        inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance.renderPass = renderPass;
+        inheritance.subpass = 0;
+        inheritance.framebuffer = swapChainFramebuffers[0];
+
+        ParallelRecorder::RecordFunction recordObjects = [this](VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)
+        {
+            recordDrawState(commandBuffer);
+            recordParallelRenderCommands(commandBuffer, first, count);
+        };
+
+        QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+        uint32_t objectCount = static_cast<uint32_t>(objects.size());
+        std::cout << "Recording " << objectCount << " draws, " << iterations << " iterations per thread count" << std::endl;
+        std::cout << "threads  ms/frame  Mdraws/s  speedup" << std::endl;
+
+        double singleThreadMs = 0.0;
+        for (uint32_t threads : threadCounts)
+        {
+            parallelRecorder.destroy();
+            parallelRecorder.init(device, indices.graphicsFamily.value(), threads, framesInFlight);
+
+            // The first pass allocates the pools' memory; it is not what is being measured
+            parallelRecorder.record(0, inheritance, objectCount, recordObjects);
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                parallelRecorder.record(i % framesInFlight, inheritance, objectCount, recordObjects);
+            }
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            double frameMs = elapsed.count() / iterations;
+            if (threads == 1)
+            {
+                singleThreadMs = frameMs;
+            }
+            std::cout << std::fixed << std::setprecision(3) << std::setw(7) << threads << std::setw(10) << frameMs
+                      << std::setprecision(2) << std::setw(10) << objectCount / frameMs / 1000.0 << std::setw(8)
+                      << (frameMs > 0.0 ? singleThreadMs / frameMs : 0.0) << "x" << std::endl;
+        }
+
+        parallelRecorder.destroy();
+        createParallelRecorder();
+    }
+
+protected:
+    // Override initVulkan to create descriptor layout before pipeline
+    void initVulkan() override
+    {
+        VulkanApp::initVulkan();
+
+        // Resources that depend on the command pool created in base init
+        createVertexBuffer();
+        createIndexBuffer();
+        createTextureImage();
+        createTextureImageView();
+        createTextureSampler();
+        createDescriptorPool();
+        createDescriptorSets();
+    }
+
+    // Override cleanup to clean up resources
+    void cleanup() override
+    {
+        vkDestroySampler(device, textureSampler, nullptr);
+        vkDestroyImageView(device, textureImageView, nullptr);
+        destroyImage(textureImage, textureImageAllocation);
+
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+
+        destroyBuffer(indexBuffer, indexBufferAllocation);
+
+        destroyBuffer(vertexBuffer, vertexBufferAllocation);
+
+        VulkanApp::cleanup();
+    }
+
+    // Create graphics pipeline with vertex input and descriptor set layout
+    void createGraphicsPipeline() override
+    {
+        // The descriptor set layout is created once and reused if the pipeline is rebuilt
+        if (descriptorSetLayout == VK_NULL_HANDLE)
+        {
+            createDescriptorSetLayout();
+        }
+
+        // Shader modules are cached, so rebuilding the pipeline never recompiles
+        VkShaderModule vertShaderModule = loadShaderModule("shader.vert", VK_SHADER_STAGE_VERTEX_BIT);
+        VkShaderModule fragShaderModule = loadShaderModule("shader.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
+
+        VkPipelineShaderStageCreateInfo vertStage{};
+        vertStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vertStage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vertStage.module = vertShaderModule;
+        vertStage.pName = "main";
+
+        VkPipelineShaderStageCreateInfo fragStage{};
+        fragStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fragStage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fragStage.module = fragShaderModule;
+        fragStage.pName = "main";
+
+        VkPipelineShaderStageCreateInfo shaderStages[] = {vertStage, fragStage};
+
+        auto bindingDescription = Vertex::getBindingDescription();
+        auto attributeDescriptions = Vertex::getAttributeDescriptions();
+
+        VkPipelineVertexInputStateCreateInfo vertexInput{};
+        vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInput.vertexBindingDescriptionCount = 1;
+        vertexInput.pVertexBindingDescriptions = &bindingDescription;
+        vertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+        vertexInput.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+        // Viewport and scissor are dynamic so the pipeline survives swapchain resizes
+        VkPipelineViewportStateCreateInfo viewportState{};
+        viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportState.viewportCount = 1;
+        viewportState.scissorCount = 1;
+
+        std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicState{};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicState.pDynamicStates = dynamicStates.data();
+
+        VkPipelineRasterizationStateCreateInfo rasterizer{};
+        rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterizer.depthClampEnable = VK_FALSE;
+        rasterizer.rasterizerDiscardEnable = VK_FALSE;
+        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterizer.lineWidth = 1.0f;
+        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+        rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+        rasterizer.depthBiasEnable = VK_FALSE;
+
+        VkPipelineMultisampleStateCreateInfo multisampling{};
+        multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisampling.sampleShadingEnable = VK_FALSE;
+        multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                              VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        colorBlendAttachment.blendEnable = VK_FALSE;
+
+        VkPipelineColorBlendStateCreateInfo colorBlending{};
+        colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlending.logicOpEnable = VK_FALSE;
+        colorBlending.attachmentCount = 1;
+        colorBlending.pAttachments = &colorBlendAttachment;
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(ObjectData);
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create pipeline layout!");
+        }
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount = 2;
+        pipelineInfo.pStages = shaderStages;
+        pipelineInfo.pVertexInputState = &vertexInput;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisampling;
+        pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.layout = _pipelineLayout;
+        pipelineInfo.renderPass = renderPass;
+        pipelineInfo.subpass = 0;
+
+        if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create graphics pipeline!");
+        }
+    }
+
+    uint32_t getParallelDrawCount() const override
+    {
+        return static_cast<uint32_t>(objects.size());
+    }
+
+    // Called concurrently for disjoint ranges of objects; only reads shared state
+    void recordParallelRenderCommands(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count) override
+    {
+        VkBuffer vertexBuffers[] = {vertexBuffer};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                _pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ObjectData), &objects[i]);
+            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+        }
+    }
+
+    // Create vertex buffer
+    void createVertexBuffer()
+    {
+        VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
+
+        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferAllocation);
+
+        uploadBatch.uploadBuffer(vertexBuffer, vertexBufferAllocation, vertices.data(), bufferSize);
+    }
+
+    // Create index buffer
+    void createIndexBuffer()
+    {
+        VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+
+        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferAllocation);
+
+        uploadBatch.uploadBuffer(indexBuffer, indexBufferAllocation, indices.data(), bufferSize);
+    }
+
+    // Create texture image
+    void createTextureImage()
+    {
+        // Create a procedural texture (checkerboard pattern)
+        int texWidth = 256;
+        int texHeight = 256;
+        int texChannels = 4; // RGBA
+
+        std::vector<unsigned char> pixels(texWidth * texHeight * texChannels);
+
+        // Generate a checkerboard pattern, with rows split across the job system
+        auto generateRow = [&](uint32_t row)
+        {
+            int y = static_cast<int>(row);
+            for (int x = 0; x < texWidth; x++)
+            {
+                bool isWhite = ((x / 32) + (y / 32)) % 2 == 0;
+
+                unsigned char r = isWhite ? 255 : 0;
+                unsigned char g = isWhite ? 0 : 255;
+                unsigned char b = 0;
+                unsigned char a = 255;
+
+                int pixelIndex = (y * texWidth + x) * texChannels;
+                pixels[pixelIndex + 0] = r;
+                pixels[pixelIndex + 1] = g;
+                pixels[pixelIndex + 2] = b;
+                pixels[pixelIndex + 3] = a;
+            }
+        };
+        jobSystem.parallelFor(static_cast<uint32_t>(texHeight), generateRow, 16);
+
+        VkDeviceSize imageSize = texWidth * texHeight * texChannels;
+
+        // Create image with a full mip chain; each level is blitted from the one above it
+        textureMipLevels = getMipLevelCount(VK_FORMAT_R8G8B8A8_SRGB, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+        createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageAllocation, textureMipLevels);
+
+        // Staged, copied and transitioned for shader access with the rest of the init uploads
+        uploadBatch.uploadImage(textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight),
+                                pixels.data(), imageSize, textureMipLevels);
+    }
+
+    // Create texture image view
+    void createTextureImageView()
+    {
+        textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB, textureMipLevels);
+    }
+
+    // Create texture sampler
+    void createTextureSampler()
+    {
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = VK_FILTER_LINEAR;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.anisotropyEnable = VK_TRUE;
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+
+        samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        samplerInfo.unnormalizedCoordinates = VK_FALSE;
+        samplerInfo.compareEnable = VK_FALSE;
+        samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.mipLodBias = 0.0f;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = static_cast<float>(textureMipLevels);
+
+        if (vkCreateSampler(device, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create texture sampler!");
+        }
+    }
+
+    // Create descriptor set layout
+    void createDescriptorSetLayout()
+    {
+        VkDescriptorSetLayoutBinding samplerLayoutBinding{};
+        samplerLayoutBinding.binding = 0;
+        samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        samplerLayoutBinding.descriptorCount = 1;
+        samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        samplerLayoutBinding.pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &samplerLayoutBinding;
+
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create descriptor set layout!");
+        }
+    }
+
+    // Create descriptor pool
+    void createDescriptorPool()
+    {
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSize.descriptorCount = 1;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        poolInfo.maxSets = 1;
+
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create descriptor pool!");
+        }
+    }
+
+    // Create descriptor sets
+    void createDescriptorSets()
+    {
+        std::vector<VkDescriptorSetLayout> layouts(1, descriptorSetLayout);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = layouts.data();
+
+        if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to allocate descriptor sets!");
+        }
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = textureImageView;
+        imageInfo.sampler = textureSampler;
+
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = descriptorSet;
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &imageInfo;
+
+        vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+    }
+
+    // Helper function to create image view
+    VkImageView createImageView(VkImage image, VkFormat format, uint32_t mipLevels)
+    {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = mipLevels;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        VkImageView imageView;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create texture image view!");
+        }
+
+        return imageView;
+    }
+
+private:
+    // Vertex data
+    std::vector<Vertex> vertices;
+    std::vector<uint16_t> indices;
+    std::vector<ObjectData> objects;
+
+    // Buffers
+    VkBuffer vertexBuffer;
+    MemoryAllocation vertexBufferAllocation;
+    VkBuffer indexBuffer;
+    MemoryAllocation indexBufferAllocation;
+
+    // Texture
+    VkImage textureImage;
+    MemoryAllocation textureImageAllocation;
+    uint32_t textureMipLevels = 1;
+    VkImageView textureImageView;
+    VkSampler textureSampler;
+
+    // Descriptor
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSet;
+};
+
+int main(int argc, char **argv)
+{
+    // Options of this example; everything else is handled by VulkanApp::parseArgs
+    //   --objects <n>             number of quads drawn, each with its own draw call
+    //   --scaling [iterations]    print recording throughput per thread count and exit
+    uint32_t objectCount = 10000;
+    uint32_t scalingIterations = 0;
+    std::vector<char *> args = {argv[0]};
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--objects" && i + 1 < argc)
+        {
+            // At least one quad, so the grid has a column to size its cells by
+            VulkanApp::parseCount(arg, argv[++i], objectCount);
+            objectCount = std::max(1u, objectCount);
+        }
+        else if (arg == "--scaling")
+        {
+            scalingIterations = 100;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+            {
+                VulkanApp::parseCount(arg, argv[++i], scalingIterations);
+            }
+            // At least one iteration, otherwise the interactive app would run instead
+            scalingIterations = std::max(1u, scalingIterations);
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+
+    ParallelRecordingApp app(800, 600, "Vulkan Parallel Recording Example", objectCount);
+    app.parseArgs(static_cast<int>(args.size()), args.data());
+    app.init();
+
+    try
+    {
+        if (scalingIterations > 0)
+        {
+            app.runScalingBenchmark(scalingIterations);
+        }
+        else
+        {
+            app.run();
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
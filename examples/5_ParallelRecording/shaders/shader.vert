@@ -0,0 +1,16 @@
+#version 450
+
+layout(push_constant) uniform ObjectData {
+    vec2 offset;
+    float scale;
+} object;
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+
+layout(location = 0) out vec2 fragTexCoord;
+
+void main() {
+    gl_Position = vec4(inPosition * object.scale + object.offset, 0.0, 1.0);
+    fragTexCoord = inTexCoord;
+}